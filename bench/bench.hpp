@@ -0,0 +1,188 @@
+// C++ 版のチャレンジ・概念で共有するマイクロベンチマークのハーネス。
+// 各プログラムは `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で
+// run_benchmarks を呼び、ケースごとに Runner::run を並べる。
+//
+// 各ケースは反復回数を増やしながら 1 試行が min_ms を超えるまで較正し（ウォームアップを兼ねる）、
+// 続く reps 回の試行で 1 回あたりの時間を測って中央値・p90・p99 を出す。
+// --json では結果を JSON で標準出力に書く（変更前後の比較用に保存しておく）。
+//
+// 各ファイルからは相対パスで読み込む（例: #include "../../../bench/bench.hpp"）。
+// ヘッダだけで完結するので、ビルドは今までどおり .cpp 1 つをコンパイルするだけでよい。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// 計測対象の結果が最適化で消されないようにする
+template<typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Options {
+    std::string filter;
+    int repetitions = 10;
+    double min_ms = 50;
+    bool json = false;
+    std::vector<std::string> inputs;  // オプション以外の引数（入力ファイルなど、使い道はケースごと）
+};
+
+inline Options parse_options(const std::vector<std::string>& args) {
+    Options options;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--filter" && has_value) {
+            options.filter = args[++i];
+        } else if (arg == "--reps" && has_value) {
+            options.repetitions = std::max(1, std::stoi(args[++i]));
+        } else if (arg == "--min-ms" && has_value) {
+            options.min_ms = std::stod(args[++i]);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return options;
+}
+
+class Runner {
+public:
+    Runner(std::string suite, Options options) : suite_(std::move(suite)), options_(std::move(options)) {}
+
+    const Options& options() const { return options_; }
+
+    // body(n) は 1 試行で対象の処理を n 回行う。items は 1 回あたりの処理量、unit はその単位
+    template<typename F>
+    void run(const std::string& name, double items, const std::string& unit, F body) {
+        if (name.find(options_.filter) == std::string::npos) return;
+
+        const double target_ns = options_.min_ms * 1e6;
+        uint64_t iterations = 1;
+        double elapsed = measure(body, iterations);
+        while (elapsed < target_ns && iterations < (uint64_t{1} << 40)) {
+            double scale = elapsed > 0 ? std::min(target_ns * 1.2 / elapsed, 10.0) : 10.0;
+            iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * scale));
+            elapsed = measure(body, iterations);
+        }
+
+        Result result{name, unit, items, iterations, {}};
+        for (int r = 0; r < options_.repetitions; ++r) {
+            result.ns_per_op.push_back(measure(body, iterations) / iterations);
+        }
+        std::sort(result.ns_per_op.begin(), result.ns_per_op.end());
+        if (!options_.json) print(result);
+        results_.push_back(std::move(result));
+    }
+
+    // --json のときは全ケースをまとめて 1 つの JSON として書き出す
+    void finish() const {
+        if (!options_.json) return;
+        std::cout << "{\"suite\":" << quoted_json(suite_)
+                  << ",\"repetitions\":" << options_.repetitions << ",\"benchmarks\":[";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            double mean = 0;
+            for (double v : r.ns_per_op) mean += v;
+            mean /= r.ns_per_op.size();
+            std::cout << (i > 0 ? "," : "") << "\n  {\"name\":" << quoted_json(r.name)
+                      << ",\"unit\":" << quoted_json(r.unit) << ",\"items_per_op\":" << r.items
+                      << ",\"iterations\":" << r.iterations
+                      << ",\"ns_per_op\":{\"min\":" << r.ns_per_op.front()
+                      << ",\"median\":" << r.percentile(50) << ",\"mean\":" << mean
+                      << ",\"p90\":" << r.percentile(90) << ",\"p99\":" << r.percentile(99)
+                      << ",\"max\":" << r.ns_per_op.back()
+                      << "},\"items_per_second\":" << r.items * 1e9 / r.percentile(50) << "}";
+        }
+        std::cout << "\n]}" << std::endl;
+    }
+
+private:
+    struct Result {
+        std::string name;
+        std::string unit;
+        double items;
+        uint64_t iterations;            // 1 試行あたりの反復回数
+        std::vector<double> ns_per_op;  // 試行ごとの 1 回あたりの時間（昇順）
+
+        // 最近順位法の百分位点
+        double percentile(double p) const {
+            size_t rank = static_cast<size_t>(std::ceil(p / 100 * ns_per_op.size()));
+            return ns_per_op[std::clamp<size_t>(rank, 1, ns_per_op.size()) - 1];
+        }
+    };
+
+    template<typename F>
+    static double measure(F& body, uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static std::string format_time(double ns) {
+        static const char* const units[] = {"ns", "us", "ms", "s"};
+        int u = 0;
+        while (ns >= 1000 && u < 3) {
+            ns /= 1000;
+            ++u;
+        }
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << ns << ' ' << units[u];
+        return oss.str();
+    }
+
+    static std::string format_rate(double per_second, const std::string& unit) {
+        static const char* const prefixes[] = {"", "k", "M", "G", "T"};
+        int p = 0;
+        while (per_second >= 1000 && p < 4) {
+            per_second /= 1000;
+            ++p;
+        }
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2) << per_second << ' ' << prefixes[p] << unit << "/s";
+        return oss.str();
+    }
+
+    static std::string quoted_json(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + '"';
+    }
+
+    void print(const Result& r) {
+        if (!header_printed_) {
+            std::cout << suite_ << " (" << options_.repetitions << " reps)" << std::endl;
+            std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "median"
+                      << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(20) << "throughput"
+                      << std::endl;
+            header_printed_ = true;
+        }
+        double median = r.percentile(50);
+        std::cout << std::left << std::setw(40) << r.name << std::right << std::setw(12) << format_time(median)
+                  << std::setw(12) << format_time(r.percentile(90)) << std::setw(12)
+                  << format_time(r.percentile(99)) << std::setw(20)
+                  << format_rate(r.items * 1e9 / median, r.unit) << std::endl;
+    }
+
+    std::string suite_;
+    Options options_;
+    std::vector<Result> results_;
+    bool header_printed_ = false;
+};
+
+}  // namespace bench
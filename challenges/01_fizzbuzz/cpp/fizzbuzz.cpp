@@ -1,12 +1,37 @@
 // FizzBuzz - C++ 実装
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ranges>
 #include <algorithm>
 #include <functional>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <csignal>
+#include <cerrno>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <system_error>
+#include <thread>
 #include <cassert>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 
@@ -227,6 +252,443 @@ void fizzbuzz_rules() {
     cout << endl << endl;
 }
 
+// === 高速出力エンジン ===
+// 規則をテンプレート引数で固定し、行をメモリ上の大きなバッファに直接組み立てる。
+// - 規則の周期（約数の最小公倍数。標準の規則なら 15）ぶんの行の並びをコンパイル時に表にしておき、
+//   行ごとの剰余演算をしない
+// - 数字は to_string せず、ASCII の 10 進数を 1 ずつ繰り上げるカウンタから書く
+// - 出力先がパイプなら vmsplice でページをそのまま渡し、それ以外は write / writev する
+// - --threads では範囲を塊に分けて各スレッドが生成し、順番どおりにまとめて書き出す
+
+// テンプレート引数に文字列リテラルを渡すための固定長文字列
+template<size_t N>
+struct FixedString {
+    char chars[N]{};
+
+    constexpr FixedString(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) chars[i] = s[i];
+    }
+
+    constexpr string_view view() const { return {chars, N - 1}; }
+};
+
+// Divisor の倍数なら Word を出す。当たった規則の語は並べた順に連結する
+template<int Divisor, FixedString Word>
+struct Rule {
+    static_assert(Divisor > 0, "約数は正の数");
+    static constexpr uint64_t divisor = Divisor;
+    static constexpr string_view word = Word.view();
+};
+
+// 10 進数の ASCII 表現を直接繰り上げるカウンタ
+class DecimalCounter {
+public:
+    explicit DecimalCounter(uint64_t value) {
+        memset(digits_, '0', sizeof(digits_));
+        char tmp[20];
+        width_ = static_cast<size_t>(to_chars(tmp, tmp + sizeof(tmp), value).ptr - tmp);
+        memcpy(digits_ + ones + 1 - width_, tmp, width_);
+        digits_[ones + 1] = '\n';
+    }
+
+    // 数字と改行を書く。固定長でコピーするので out の後ろに line_slack バイトの余裕が要る
+    char* write_line(char* out) const {
+        memcpy(out, digits_ + ones + 1 - width_, line_slack);
+        return out + width_ + 1;
+    }
+
+    void increment() {
+        size_t i = ones;
+        while (digits_[i] == '9') digits_[i--] = '0';
+        ++digits_[i];
+        width_ = max(width_, ones + 1 - i);
+    }
+
+    static constexpr size_t line_slack = 32;
+
+private:
+    static constexpr size_t ones = 31;  // 1 の位の位置。左側は '0' で埋めておく
+    char digits_[ones + 1 + line_slack];
+    size_t width_;
+};
+
+template<typename... Rules>
+class FizzBuzzEngine {
+public:
+    static constexpr uint64_t period = [] {
+        uint64_t p = 1;
+        ((p = lcm(p, Rules::divisor)), ...);
+        return p;
+    }();
+    static_assert(period <= 65536, "規則の周期が大きすぎる");
+
+    // 周期内の位置ごとの行。length は改行込みで、0 なら数字の行
+    struct Line {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    static constexpr size_t text_size = [] {
+        size_t total = 0;
+        for (uint64_t r = 0; r < period; ++r) {
+            size_t length = ((r % Rules::divisor == 0 ? Rules::word.size() : 0) + ...);
+            if (length > 0) total += length + 1;
+        }
+        return total;
+    }();
+
+    struct Table {
+        array<Line, period> lines{};
+        array<char, text_size> text{};
+        size_t longest = 0;
+    };
+
+    static constexpr Table table = [] {
+        Table t;
+        size_t pos = 0;
+        for (uint64_t r = 0; r < period; ++r) {
+            size_t start = pos;
+            auto append = [&](uint64_t divisor, string_view word) {
+                if (r % divisor != 0) return;
+                for (char c : word) t.text[pos++] = c;
+            };
+            (append(Rules::divisor, Rules::word), ...);
+            if (pos == start) continue;
+            t.text[pos++] = '\n';
+            t.lines[r] = {static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start)};
+            t.longest = max(t.longest, pos - start);
+        }
+        return t;
+    }();
+
+    // 1 行の最大バイト数（20 桁の数字 + 改行か、最長の語の行）
+    static constexpr size_t max_line_bytes = max<size_t>(21, table.longest);
+
+    // i 行目の語（改行なし）。規則に当たらなければ空。コンパイル時にも使える
+    static constexpr string_view word(uint64_t i) {
+        const Line& line = table.lines[i % period];
+        if (line.length == 0) return {};
+        return string_view(table.text.data() + line.offset, line.length - 1);
+    }
+
+    // first 行目から順に書いていく位置。剰余はここで 1 回だけ取る
+    class Cursor {
+    public:
+        explicit Cursor(uint64_t first) : counter_(first), slot_(first % period) {}
+
+        // lines 行を out に書いて終端を返す。out には lines * max_line_bytes + line_slack の余裕が要る
+        char* write(char* out, uint64_t lines) {
+            for (uint64_t n = 0; n < lines; ++n) {
+                const Line& line = table.lines[slot_];
+                if (line.length == 0) {
+                    out = counter_.write_line(out);
+                } else {
+                    memcpy(out, table.text.data() + line.offset, line.length);
+                    out += line.length;
+                }
+                counter_.increment();
+                if (++slot_ == period) slot_ = 0;
+            }
+            return out;
+        }
+
+    private:
+        DecimalCounter counter_;
+        uint64_t slot_;
+    };
+};
+
+using ClassicFizzBuzz = FizzBuzzEngine<Rule<3, "Fizz">, Rule<5, "Buzz">>;
+
+// 表の判定が fizzbuzz_constexpr と一致することをコンパイル時に確かめる
+static_assert([] {
+    for (int i = 1; i <= 300; ++i) {
+        auto r = fizzbuzz_constexpr(i);
+        string_view w = ClassicFizzBuzz::word(i);
+        if (r.is_fizzbuzz != (w == "FizzBuzz") || r.is_fizz != (w == "Fizz") ||
+            r.is_buzz != (w == "Buzz")) {
+            return false;
+        }
+    }
+    return true;
+}());
+
+// ページ境界（大きければ 2 MiB 境界）に揃えたバッファ
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t size) {
+        size_t alignment = size >= huge_page ? huge_page : 4096;
+        size_ = (size + alignment - 1) / alignment * alignment;
+        data_ = static_cast<char*>(aligned_alloc(alignment, size_));
+        if (!data_) throw bad_alloc();
+#if defined(__linux__)
+        if (alignment == huge_page) madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+    }
+
+    ~AlignedBuffer() { free(data_); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    static constexpr size_t huge_page = 2 << 20;
+    char* data_;
+    size_t size_;
+};
+
+// 出力先 fd。パイプなら vmsplice でユーザー空間のページをパイプに直接つなぐ（コピーしない）。
+// つないだページは読み手が取り出すまで参照されるので、書き換えてよいのは
+// その後にパイプの容量ぶん以上を書き終えてから
+class OutputSink {
+public:
+    // splice が false なら、パイプでも writev だけを使う
+    explicit OutputSink(int fd, bool splice = true, size_t preferred_pipe_size = 1 << 20) : fd_(fd) {
+#if defined(__linux__)
+        struct stat st{};
+        if (splice && fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode)) {
+            fcntl(fd, F_SETPIPE_SZ, static_cast<int>(preferred_pipe_size));  // 上限を超えると失敗するが、今の容量で続ける
+            int size = fcntl(fd, F_GETPIPE_SZ);
+            pipe_size_ = size > 0 ? static_cast<size_t>(size) : 0;
+        }
+#else
+        (void)splice;
+        (void)preferred_pipe_size;
+#endif
+    }
+
+    // 0 ならパイプではない
+    size_t pipe_size() const { return pipe_size_; }
+
+    // 読み手が閉じた (EPIPE) ときは false。それ以外の失敗は例外
+    bool write(const char* data, size_t size) {
+        iovec iov{const_cast<char*>(data), size};
+        return write(&iov, 1);
+    }
+
+    // パイプでも vmsplice せずにコピーして書く（書き終えたらすぐバッファを使い回せる）
+    bool copy(const char* data, size_t size) {
+        iovec iov{const_cast<char*>(data), size};
+        return write(&iov, 1, false);
+    }
+
+    // iov は書けた分だけ進めるので呼び出し後の中身は不定
+    bool write(iovec* iov, int count, bool splice = true) {
+        while (count > 0) {
+#if defined(__linux__)
+            ssize_t n = splice && pipe_size_ ? vmsplice(fd_, iov, static_cast<size_t>(count), 0)
+                                             : writev(fd_, iov, count);
+#else
+            ssize_t n = writev(fd_, iov, count);
+#endif
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EPIPE) return false;
+                throw system_error(errno, generic_category(), "write");
+            }
+            auto written = static_cast<size_t>(n);
+            while (count > 0 && written >= iov->iov_len) {
+                written -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+                iov->iov_len -= written;
+            }
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    size_t pipe_size_ = 0;
+};
+
+// 1 スレッドで count 行を書く。パイプにはちょうど容量ぶんずつ書き、2 枚のバッファを交互に使う。
+// 1 枚を書き終えた時点でパイプの中身はその 1 枚だけなので、もう 1 枚は読み手が取り出し済み。
+// 容量からあふれた行は次の 1 枚の先頭へ移す。
+// vmsplice したページは関数を抜けた後も読み手が取り出すまでパイプに残るので、
+// 後ろに容量ぶん以上が続くと分かっている 1 枚だけを vmsplice し、最後の容量ぶんはコピーして書く
+// （それを書き終えた時点で、vmsplice したページはすべて取り出し済みになり、バッファを解放してよい）
+template<typename Engine>
+bool write_sequential(OutputSink& sink, uint64_t count) {
+    constexpr uint64_t min_line_bytes = 2;  // 1 桁の数字 + 改行。語の行はこれより長い
+    size_t block = sink.pipe_size() ? sink.pipe_size() : size_t{2} << 20;
+    size_t slack = Engine::max_line_bytes + DecimalCounter::line_slack;
+    AlignedBuffer buffers[2] = {AlignedBuffer(block + slack), AlignedBuffer(block + slack)};
+    typename Engine::Cursor cursor(1);
+
+    int current = 0;
+    size_t carry = 0;
+    while (count > 0) {
+        char* begin = buffers[current].data();
+        char* out = begin + carry;
+        char* limit = begin + block;
+        while (out < limit && count > 0) {
+            uint64_t room = static_cast<uint64_t>(limit - out) / Engine::max_line_bytes;
+            uint64_t lines = min(count, max<uint64_t>(room, 1));
+            out = cursor.write(out, lines);
+            count -= lines;
+        }
+
+        size_t filled = static_cast<size_t>(out - begin);
+        size_t chunk = min(filled, block);
+        bool splice = count >= block / min_line_bytes;
+        if (!(splice ? sink.write(begin, chunk) : sink.copy(begin, chunk))) return false;
+        carry = filled - chunk;
+        current ^= 1;
+        memcpy(buffers[current].data(), begin + chunk, carry);
+    }
+    return carry == 0 || sink.copy(buffers[current].data(), carry);
+}
+
+// 行を chunk_lines ずつの塊に分け、塊 c をスレッド c % threads が生成する。
+// 塊はスロットのリング (2 × threads) に置き、メインスレッドが揃った順に writev でまとめて書く。
+// スロットの seq が c なら塊 c 用に空いていて、c + 1 なら塊 c が書き込み待ち。
+// writev はコピーするので書き終えたスロットはすぐ使い回せる（このモードでは vmsplice を使わない）
+template<typename Engine>
+bool write_parallel(int fd, uint64_t count, unsigned threads) {
+    constexpr uint64_t chunk_lines = 1 << 15;
+    constexpr int max_batch = 16;
+    const uint64_t chunks = count / chunk_lines + (count % chunk_lines != 0);
+    const size_t slot_count = 2 * size_t{threads};
+    const size_t capacity = chunk_lines * Engine::max_line_bytes + DecimalCounter::line_slack;
+
+    struct alignas(64) Slot {
+        atomic<uint64_t> seq;
+        size_t size = 0;
+        unique_ptr<AlignedBuffer> buffer;
+    };
+    vector<Slot> slots(slot_count);
+    for (size_t s = 0; s < slot_count; ++s) {
+        slots[s].seq.store(s, memory_order_relaxed);
+        slots[s].buffer = make_unique<AlignedBuffer>(capacity);
+    }
+    atomic<bool> stop{false};
+
+    // seq が want になるまで待つ。止められたら false
+    auto wait_for = [&](Slot& slot, uint64_t want) {
+        uint64_t seen;
+        while ((seen = slot.seq.load(memory_order_acquire)) != want) {
+            if (stop.load(memory_order_relaxed)) return false;
+            slot.seq.wait(seen, memory_order_acquire);
+        }
+        return true;
+    };
+
+    vector<thread> workers;
+    for (unsigned w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w] {
+            for (uint64_t c = w; c < chunks; c += threads) {
+                Slot& slot = slots[c % slot_count];
+                if (!wait_for(slot, c)) return;
+                uint64_t first = 1 + c * chunk_lines;
+                uint64_t lines = min(chunk_lines, count - c * chunk_lines);
+                typename Engine::Cursor cursor(first);
+                char* begin = slot.buffer->data();
+                slot.size = static_cast<size_t>(cursor.write(begin, lines) - begin);
+                slot.seq.store(c + 1, memory_order_release);
+                slot.seq.notify_all();
+            }
+        });
+    }
+
+    // 途中で読み手が閉じても、待っているワーカーを起こして必ず join する
+    auto shutdown = [&] {
+        stop.store(true);
+        for (auto& slot : slots) {
+            slot.seq.store(numeric_limits<uint64_t>::max(), memory_order_release);  // 値を変えないと wait は起きない
+            slot.seq.notify_all();
+        }
+        for (auto& t : workers) t.join();
+    };
+
+    OutputSink sink(fd, false);
+    bool ok = true;
+    try {
+        for (uint64_t c = 0; c < chunks && ok;) {
+            iovec iov[max_batch];
+            int batch = 0;
+            if (!wait_for(slots[c % slot_count], c + 1)) break;
+            do {
+                Slot& slot = slots[(c + batch) % slot_count];
+                iov[batch] = {slot.buffer->data(), slot.size};
+                ++batch;
+            } while (batch < max_batch && c + batch < chunks &&
+                     slots[(c + batch) % slot_count].seq.load(memory_order_acquire) == c + batch + 1);
+
+            ok = sink.write(iov, batch);
+            for (int b = 0; b < batch; ++b, ++c) {
+                Slot& slot = slots[c % slot_count];
+                slot.seq.store(c + slot_count, memory_order_release);
+                slot.seq.notify_all();
+            }
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+    shutdown();
+    return ok;
+}
+
+// `--fast [行数] [--threads N]` で 1 から行数ぶんを標準出力に書く。
+// 行数を省くか 0 なら読み手が閉じるまで書き続ける（パイプのスループット計測用）
+int run_fast(const vector<string>& args) {
+    auto parse = [](const string& s, auto& value) {
+        auto [ptr, ec] = from_chars(s.data(), s.data() + s.size(), value);
+        return ec == errc() && ptr == s.data() + s.size();
+    };
+    uint64_t count = 0;
+    unsigned threads = 1;
+    for (size_t i = 0; i < args.size(); ++i) {
+        bool ok = args[i] == "--threads"
+            ? i + 1 < args.size() && parse(args[++i], threads) && threads > 0
+            : parse(args[i], count);
+        if (!ok) {
+            cerr << "Error: invalid argument '" << args[i] << "'" << endl;
+            cerr << "Usage: fizzbuzz --fast [N] [--threads T]" << endl;
+            return 1;
+        }
+    }
+    if (count == 0) count = numeric_limits<uint64_t>::max() - 1;
+
+    signal(SIGPIPE, SIG_IGN);  // 読み手が閉じたら EPIPE を受けて静かに終わる
+    try {
+        if (threads > 1) {
+            write_parallel<ClassicFizzBuzz>(STDOUT_FILENO, count, threads);
+        } else {
+            OutputSink sink(STDOUT_FILENO);
+            write_sequential<ClassicFizzBuzz>(sink, count);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+void fast_engine_demo() {
+    cout << "--- Compile-time Rule Engine ---" << endl;
+
+    char buffer[15 * ClassicFizzBuzz::max_line_bytes + DecimalCounter::line_slack];
+    ClassicFizzBuzz::Cursor cursor(1);
+    string_view lines(buffer, static_cast<size_t>(cursor.write(buffer, 15) - buffer));
+    for (char c : lines) cout << (c == '\n' ? ' ' : c);
+    cout << endl;
+
+    // 規則を足すと周期は最小公倍数になる
+    using Extended = FizzBuzzEngine<Rule<3, "Fizz">, Rule<5, "Buzz">, Rule<7, "Bazz">>;
+    cout << "period " << ClassicFizzBuzz::period << " -> " << Extended::period
+         << ", 105: " << Extended::word(105) << ", 21: " << Extended::word(21) << endl;
+    cout << "(fizzbuzz --fast [N] [--threads T] | pv > /dev/null でパイプの速さを測れる)" << endl;
+    cout << endl;
+}
+
 // === テスト ===
 void run_tests() {
     cout << "--- Tests ---" << endl;
@@ -248,10 +710,110 @@ void run_tests() {
     // FizzBuzz (15の倍数)
     assert(result[14] == "FizzBuzz");
 
+    // 高速エンジン: 途中から始めても、桁が増える境目をまたいでも同じ行になる
+    auto expected = [](uint64_t first, uint64_t count) {
+        string out;
+        for (uint64_t i = first; i < first + count; ++i) {
+            out += fizzbuzz_transform(static_cast<int>(i));
+            out += '\n';
+        }
+        return out;
+    };
+    for (uint64_t first : {1, 14, 99'990, 999'999}) {
+        vector<char> buffer(100 * ClassicFizzBuzz::max_line_bytes + DecimalCounter::line_slack);
+        ClassicFizzBuzz::Cursor cursor(first);
+        string_view got(buffer.data(), static_cast<size_t>(cursor.write(buffer.data(), 100) - buffer.data()));
+        assert(got == expected(first, 100));
+    }
+
+    // パイプ経由（vmsplice / 塊ごとの writev）でも欠けや順序の乱れがない
+    auto through_pipe = [](auto&& write) {
+        int fds[2];
+        [[maybe_unused]] int rc = pipe(fds);
+        assert(rc == 0);
+        string out;
+        thread reader([&] {
+            char chunk[1 << 16];
+            ssize_t n;
+            // 遅い読み手: 書き手が返った時点でパイプに中身が残っているようにする
+            while ((n = read(fds[0], chunk, sizeof(chunk))) > 0) {
+                out.append(chunk, static_cast<size_t>(n));
+                this_thread::sleep_for(chrono::microseconds(500));
+            }
+        });
+        write(fds[1]);
+        // 書き手が返した後にその領域が使い回されても、読み手に届く中身は変わらない
+        vector<unique_ptr<char[]>> reuse;
+        for (int i = 0; i < 8; ++i) {
+            reuse.emplace_back(new char[1 << 20]);
+            memset(reuse.back().get(), 'Z', 1 << 20);
+        }
+        close(fds[1]);
+        reader.join();
+        close(fds[0]);
+        return out;
+    };
+    constexpr uint64_t lines = 200'000;
+    string want = expected(1, lines);
+    assert(through_pipe([](int fd) {
+        OutputSink sink(fd);
+        return write_sequential<ClassicFizzBuzz>(sink, lines);
+    }) == want);
+    assert(through_pipe([](int fd) { return write_parallel<ClassicFizzBuzz>(fd, lines, 3); }) == want);
+
     cout << "All tests passed!" << endl;
 }
 
-int main() {
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+// 1..100 万の出力をメモリ上に作る速さを実装ごとに比べる（端末への書き込みは含めない）。
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("fizzbuzz", options);
+    constexpr int n = 1'000'000;
+
+    runner.run("functional/1M", n, "num", [](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) bench::keep(fizzbuzz_functional(n));
+    });
+    runner.run("generator/1M", n, "num", [](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            string out;
+            for (const auto& s : FizzBuzzGenerator(1, n)) {
+                out += s;
+                out += '\n';
+            }
+            bench::keep(out);
+        }
+    });
+    runner.run("transform_append/1M", n, "num", [](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            string out;
+            for (int i = 1; i <= n; ++i) {
+                out += fizzbuzz_transform(i);
+                out += '\n';
+            }
+            bench::keep(out);
+        }
+    });
+    runner.run("engine/1M", n, "num", [](uint64_t iterations) {
+        static vector<char> buffer(n * ClassicFizzBuzz::max_line_bytes + DecimalCounter::line_slack);
+        for (uint64_t r = 0; r < iterations; ++r) {
+            ClassicFizzBuzz::Cursor cursor(1);
+            bench::keep(cursor.write(buffer.data(), n));
+        }
+    });
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        return 0;
+    }
+    if (argc > 1 && string_view(argv[1]) == "--fast") {
+        return run_fast(vector<string>(argv + 2, argv + argc));
+    }
+
     cout << "=== FizzBuzz Demo ===" << endl << endl;
 
     fizzbuzz_basic(15);
@@ -262,6 +824,7 @@ int main() {
     constexpr_demo();
     generator_demo();
     fizzbuzz_rules();
+    fast_engine_demo();
     run_tests();
 
     return 0;
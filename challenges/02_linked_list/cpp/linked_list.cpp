@@ -1,11 +1,29 @@
 // LinkedList - C++ 実装
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <memory>
 #include <optional>
 #include <vector>
+#include <list>
+#include <deque>
+#include <algorithm>
+#include <ranges>
+#include <new>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
 #include <cassert>
 
+#include "../../../bench/bench.hpp"
+
 using namespace std;
 
 // === LinkedList ===
@@ -86,6 +104,9 @@ public:
 
     LinkedList() : head_(nullptr), tail_(nullptr), size_(0) {}
 
+    // unique_ptr の連鎖に任せると要素数ぶん再帰してスタックを使い切るので、先頭から順に外す
+    ~LinkedList() { clear(); }
+
     // コピーコンストラクタ
     LinkedList(const LinkedList& other) : LinkedList() {
         for (const auto& value : other) {
@@ -114,6 +135,7 @@ public:
     // ムーブ代入
     LinkedList& operator=(LinkedList&& other) noexcept {
         if (this != &other) {
+            clear();
             head_ = move(other.head_);
             tail_ = other.tail_;
             size_ = other.size_;
@@ -149,6 +171,31 @@ public:
         ++size_;
     }
 
+    // range の要素を末尾にまとめて追加する
+    template<ranges::input_range R>
+    void append_range(R&& range) {
+        for (auto&& value : range) {
+            push_back(value);
+        }
+    }
+
+    // other の全ノードを末尾につなぎ替える（O(1)、要素のコピーも確保もしない）
+    void splice_back(LinkedList& other) {
+        if (this == &other || !other.head_) return;
+        Node* other_tail = other.tail_;
+        if (tail_) {
+            tail_->next = move(other.head_);
+        } else {
+            head_ = move(other.head_);
+        }
+        tail_ = other_tail;
+        size_ += other.size_;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    void splice_back(LinkedList&& other) { splice_back(other); }
+
     // 先頭を削除
     optional<T> pop_front() {
         if (!head_) return nullopt;
@@ -242,9 +289,11 @@ public:
         head_ = move(prev);
     }
 
-    // クリア
+    // クリア（ノードを 1 つずつ外すので再帰しない）
     void clear() {
-        head_ = nullptr;
+        while (head_) {
+            head_ = move(head_->next);
+        }
         tail_ = nullptr;
         size_ = 0;
     }
@@ -283,6 +332,410 @@ private:
     size_t size_;
 };
 
+// === UnrolledList ===
+// 1 ブロック（既定 128 バイト = キャッシュライン 2 本）に複数の要素を詰める連結リスト。
+// 走査はブロック内の連続したメモリを読むので、要素ごとにポインタを辿る LinkedList より
+// キャッシュミスがずっと少ない。各ブロックは [begin, end) に要素を持ち、空のブロックは残さない。
+// 先頭側は右詰め・末尾側は左詰めで埋めるので、push_front / push_back / pop_front は O(1)。
+// 解放したブロックは少数だけ手元に残して再利用する（キューとして使うときに確保を繰り返さない）。
+template<typename T, size_t BlockBytes = 128>
+class UnrolledList {
+    static constexpr size_t header_bytes = sizeof(void*) + 2 * sizeof(uint32_t);
+
+public:
+    static constexpr size_t block_capacity =
+        BlockBytes > header_bytes + sizeof(T) ? (BlockBytes - header_bytes) / sizeof(T) : 1;
+
+private:
+    struct alignas(64) Block {
+        Block* next = nullptr;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        alignas(T) unsigned char storage[block_capacity * sizeof(T)];
+
+        T* slot(size_t i) { return launder(reinterpret_cast<T*>(storage) + i); }
+        const T* slot(size_t i) const { return launder(reinterpret_cast<const T*>(storage) + i); }
+        T* first() { return slot(begin); }
+        T* last() { return slot(end); }
+        const T* first() const { return slot(begin); }
+        const T* last() const { return slot(end); }
+    };
+
+public:
+    // イテレータ
+    class Iterator {
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator(Block* block = nullptr, uint32_t index = 0) : block_(block), index_(index) {}
+
+        reference operator*() { return *block_->slot(index_); }
+        pointer operator->() { return block_->slot(index_); }
+
+        Iterator& operator++() {
+            if (++index_ == block_->end) {
+                block_ = block_->next;
+                index_ = block_ ? block_->begin : 0;
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return block_ == other.block_ && index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+    private:
+        Block* block_;
+        uint32_t index_;
+    };
+
+    // const イテレータ
+    class ConstIterator {
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator(const Block* block = nullptr, uint32_t index = 0) : block_(block), index_(index) {}
+
+        reference operator*() const { return *block_->slot(index_); }
+        pointer operator->() const { return block_->slot(index_); }
+
+        ConstIterator& operator++() {
+            if (++index_ == block_->end) {
+                block_ = block_->next;
+                index_ = block_ ? block_->begin : 0;
+            }
+            return *this;
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return block_ == other.block_ && index_ == other.index_;
+        }
+
+        bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+
+    private:
+        const Block* block_;
+        uint32_t index_;
+    };
+
+    UnrolledList() = default;
+
+    ~UnrolledList() {
+        clear();
+        while (spare_) {
+            Block* next = spare_->next;
+            delete spare_;
+            spare_ = next;
+        }
+    }
+
+    UnrolledList(const UnrolledList& other) : UnrolledList() {
+        append_range(other);
+    }
+
+    UnrolledList(UnrolledList&& other) noexcept
+        : head_(other.head_), tail_(other.tail_), size_(other.size_) {
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    UnrolledList& operator=(const UnrolledList& other) {
+        if (this != &other) {
+            UnrolledList tmp(other);
+            swap(*this, tmp);
+        }
+        return *this;
+    }
+
+    UnrolledList& operator=(UnrolledList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            head_ = other.head_;
+            tail_ = other.tail_;
+            size_ = other.size_;
+            other.head_ = nullptr;
+            other.tail_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    // 末尾に追加
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (tail_ && tail_->end < block_capacity) {
+            T* value = new (tail_->last()) T(forward<Args>(args)...);
+            ++tail_->end;
+            ++size_;
+            return *value;
+        }
+        Block* block = new_block(0, forward<Args>(args)...);
+        if (tail_) {
+            tail_->next = block;
+        } else {
+            head_ = block;
+        }
+        tail_ = block;
+        ++size_;
+        return *block->first();
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(move(value)); }
+
+    // 先頭に追加
+    void push_front(const T& value) {
+        if (head_ && head_->begin > 0) {
+            new (head_->slot(head_->begin - 1)) T(value);
+            --head_->begin;
+        } else {
+            Block* block = new_block(block_capacity - 1, value);
+            block->next = head_;
+            head_ = block;
+            if (!tail_) tail_ = block;
+        }
+        ++size_;
+    }
+
+    // range の要素を末尾にまとめて追加する
+    template<ranges::input_range R>
+    void append_range(R&& range) {
+        for (auto&& value : range) {
+            emplace_back(value);
+        }
+    }
+
+    // other の全ブロックを末尾につなぎ替える（O(1)）
+    void splice_back(UnrolledList& other) {
+        if (this == &other || !other.head_) return;
+        if (tail_) {
+            tail_->next = other.head_;
+        } else {
+            head_ = other.head_;
+        }
+        tail_ = other.tail_;
+        size_ += other.size_;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.size_ = 0;
+    }
+
+    void splice_back(UnrolledList&& other) { splice_back(other); }
+
+    // 先頭を削除
+    optional<T> pop_front() {
+        if (!head_) return nullopt;
+
+        T* slot = head_->first();
+        T value = move(*slot);
+        slot->~T();
+        if (++head_->begin == head_->end) {
+            Block* next = head_->next;
+            release_block(head_);
+            head_ = next;
+            if (!head_) tail_ = nullptr;
+        }
+        --size_;
+        return value;
+    }
+
+    optional<reference_wrapper<T>> front() {
+        if (!head_) return nullopt;
+        return *head_->first();
+    }
+
+    optional<reference_wrapper<const T>> front() const {
+        if (!head_) return nullopt;
+        return *head_->first();
+    }
+
+    optional<reference_wrapper<T>> back() {
+        if (!tail_) return nullopt;
+        return *(tail_->last() - 1);
+    }
+
+    optional<reference_wrapper<const T>> back() const {
+        if (!tail_) return nullopt;
+        return *(tail_->last() - 1);
+    }
+
+    // 検索（ブロック内は配列として走査する）
+    bool contains(const T& value) const {
+        for (const Block* block = head_; block; block = block->next) {
+            if (find(block->first(), block->last(), value) != block->last()) return true;
+        }
+        return false;
+    }
+
+    // 最初に見つかった value を削除する。ブロック内の後ろの要素を 1 つ詰める
+    bool remove(const T& value) {
+        Block* prev = nullptr;
+        for (Block* block = head_; block; prev = block, block = block->next) {
+            T* found = find(block->first(), block->last(), value);
+            if (found == block->last()) continue;
+
+            T* last = block->last();
+            move(found + 1, last, found);
+            (last - 1)->~T();
+            --block->end;
+            --size_;
+
+            if (block->begin == block->end) {
+                Block* next = block->next;
+                if (prev) {
+                    prev->next = next;
+                } else {
+                    head_ = next;
+                }
+                if (block == tail_) tail_ = prev;
+                release_block(block);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // 反転: ブロックの並びと各ブロック内の要素をそれぞれ反転する
+    void reverse() {
+        Block* prev = nullptr;
+        Block* block = head_;
+        tail_ = head_;
+        while (block) {
+            std::reverse(block->first(), block->last());
+            Block* next = block->next;
+            block->next = prev;
+            prev = block;
+            block = next;
+        }
+        head_ = prev;
+    }
+
+    // クリア（ループで解放するので要素数によらずスタックを使わない）
+    void clear() {
+        Block* block = head_;
+        while (block) {
+            Block* next = block->next;
+            destroy_values(block);
+            release_block(block);
+            block = next;
+        }
+        head_ = nullptr;
+        tail_ = nullptr;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    Iterator begin() { return head_ ? Iterator(head_, head_->begin) : end(); }
+    Iterator end() { return Iterator(); }
+    ConstIterator begin() const { return head_ ? ConstIterator(head_, head_->begin) : end(); }
+    ConstIterator end() const { return ConstIterator(); }
+
+    // vector に変換（ブロック単位でまとめてコピー）
+    vector<T> to_vector() const {
+        vector<T> result;
+        result.reserve(size_);
+        for (const Block* block = head_; block; block = block->next) {
+            result.insert(result.end(), block->first(), block->last());
+        }
+        return result;
+    }
+
+    friend void swap(UnrolledList& a, UnrolledList& b) noexcept {
+        using std::swap;
+        swap(a.head_, b.head_);
+        swap(a.tail_, b.tail_);
+        swap(a.size_, b.size_);
+        swap(a.spare_, b.spare_);
+        swap(a.spare_count_, b.spare_count_);
+    }
+
+private:
+    static constexpr size_t max_spare = 4;
+
+    // index の位置に 1 要素だけ構築したブロックを返す（構築に失敗したらブロックは戻す）
+    template<typename... Args>
+    Block* new_block(size_t index, Args&&... args) {
+        Block* block = spare_;
+        if (block) {
+            spare_ = block->next;
+            --spare_count_;
+        } else {
+            block = new Block;
+        }
+        try {
+            new (block->slot(index)) T(forward<Args>(args)...);
+        } catch (...) {
+            release_block(block);
+            throw;
+        }
+        block->next = nullptr;
+        block->begin = static_cast<uint32_t>(index);
+        block->end = static_cast<uint32_t>(index + 1);
+        return block;
+    }
+
+    void release_block(Block* block) {
+        if (spare_count_ < max_spare) {
+            block->next = spare_;
+            spare_ = block;
+            ++spare_count_;
+        } else {
+            delete block;
+        }
+    }
+
+    static void destroy_values(Block* block) {
+        if constexpr (!is_trivially_destructible_v<T>) {
+            for (T* p = block->first(); p != block->last(); ++p) p->~T();
+        }
+    }
+
+    Block* head_ = nullptr;
+    Block* tail_ = nullptr;
+    size_t size_ = 0;
+    Block* spare_ = nullptr;
+    size_t spare_count_ = 0;
+};
+
+// 出力演算子
+template<typename T, size_t BlockBytes>
+ostream& operator<<(ostream& os, const UnrolledList<T, BlockBytes>& list) {
+    os << "[";
+    bool first = true;
+    for (const auto& v : list) {
+        if (!first) os << " -> ";
+        os << v;
+        first = false;
+    }
+    os << "]";
+    return os;
+}
+
 // 出力演算子
 template<typename T>
 ostream& operator<<(ostream& os, const LinkedList<T>& list) {
@@ -297,6 +750,294 @@ ostream& operator<<(ostream& os, const LinkedList<T>& list) {
     return os;
 }
 
+// === EpochDomain ===
+// エポックベースのメモリ回収 (EBR)。ロックフリー構造から外したノードはすぐには delete せず、
+// そのノードを見ている可能性のあるスレッドが全員いなくなってから解放する。
+// - 読み書きする側は Guard の間だけ「現在のエポックに居る」と登録する
+// - 全スレッドが現在のエポックに追いついたらエポックを 1 進める
+// - エポック r で退避したノードは、エポックが r + 2 になれば誰からも見えない
+class EpochDomain {
+    struct ThreadState;
+
+public:
+    static constexpr size_t max_threads = 256;
+
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    ~EpochDomain() {
+        for (const auto& r : orphans_) r.deleter(r.ptr);
+    }
+
+    // スコープの間、このスレッドが触るノードは解放されない（入れ子にできる）
+    class Guard {
+    public:
+        Guard() : state_(instance().thread_state()) {
+            if (state_.nesting++ == 0) {
+                state_.slot->state.store(instance().epoch_.load() << 1 | 1);
+                // 登録をこの後のポインタ読み出しより先に見せる
+                atomic_thread_fence(memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (--state_.nesting == 0) {
+                state_.slot->state.store(0, memory_order_release);
+            }
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        ThreadState& state_;
+    };
+
+    // p を後で deleter(p) で解放する
+    void retire(void* p, void (*deleter)(void*)) {
+        ThreadState& state = thread_state();
+        state.retired.push_back({p, deleter, epoch_.load()});
+        if (state.retired.size() >= collect_threshold) collect(state);
+    }
+
+private:
+    static constexpr size_t collect_threshold = 64;
+
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    struct alignas(64) Slot {
+        atomic<uint64_t> state{0};  // (エポック << 1) | 使用中
+        atomic<bool> in_use{false};
+    };
+
+    struct ThreadState {
+        Slot* slot = nullptr;
+        size_t nesting = 0;
+        vector<Retired> retired;
+
+        // スレッド終了時: 未解放のノードはドメインに預け、スロットを返す
+        ~ThreadState() {
+            if (!slot) return;
+            EpochDomain& domain = instance();
+            if (!retired.empty()) {
+                lock_guard<mutex> lock(domain.orphan_mtx_);
+                domain.orphans_.insert(domain.orphans_.end(), retired.begin(), retired.end());
+                domain.orphan_count_.store(domain.orphans_.size(), memory_order_relaxed);
+            }
+            slot->state.store(0);
+            slot->in_use.store(false, memory_order_release);
+        }
+    };
+
+    EpochDomain() = default;
+
+    ThreadState& thread_state() {
+        static thread_local ThreadState state;
+        if (!state.slot) {
+            for (Slot& slot : slots_) {
+                bool expected = false;
+                if (!slot.in_use.load(memory_order_relaxed) && slot.in_use.compare_exchange_strong(expected, true)) {
+                    state.slot = &slot;
+                    break;
+                }
+            }
+            if (!state.slot) throw runtime_error("EpochDomain: too many threads");
+        }
+        return state;
+    }
+
+    // 使用中のスロットが全て現在のエポックにいればエポックを進める
+    void try_advance() {
+        uint64_t epoch = epoch_.load();
+        for (const Slot& slot : slots_) {
+            uint64_t s = slot.state.load();
+            if ((s & 1) && (s >> 1) != epoch) return;
+        }
+        epoch_.compare_exchange_strong(epoch, epoch + 1);
+    }
+
+    void collect(ThreadState& state) {
+        try_advance();
+        uint64_t epoch = epoch_.load();
+        auto safe = [epoch](const Retired& r) { return r.epoch + 2 <= epoch; };
+
+        // retired はエポック順なので先頭から解放できる分だけ解放する
+        auto it = state.retired.begin();
+        for (; it != state.retired.end() && safe(*it); ++it) it->deleter(it->ptr);
+        state.retired.erase(state.retired.begin(), it);
+
+        // 終了したスレッドの置き土産
+        if (orphan_count_.load(memory_order_relaxed) == 0) return;
+        lock_guard<mutex> lock(orphan_mtx_);
+        auto keep = partition(orphans_.begin(), orphans_.end(), [&](const Retired& r) { return !safe(r); });
+        for (auto o = keep; o != orphans_.end(); ++o) o->deleter(o->ptr);
+        orphans_.erase(keep, orphans_.end());
+        orphan_count_.store(orphans_.size(), memory_order_relaxed);
+    }
+
+    Slot slots_[max_threads];
+    alignas(64) atomic<uint64_t> epoch_{1};
+    atomic<size_t> orphan_count_{0};
+    mutex orphan_mtx_;
+    vector<Retired> orphans_;
+};
+
+// === ConcurrentLinkedList ===
+// Michael-Scott のロックフリーキュー。push_back / pop_front は複数スレッドから同時に呼べる。
+// head は常にダミーノードを指し、pop はダミーを 1 つ進めて古いダミーを EpochDomain に退避する。
+// snapshot() はエポックのガードを持ったまま辿るので、走査中に pop されたノードも解放されない
+// （弱い一貫性: 走査中の push / pop が見えるかどうかは不定）。
+// pop_front は値をムーブせずコピーで取り出す。同じノードを読んでいるスナップショットと競合しないため。
+template<typename T>
+class ConcurrentLinkedList {
+    struct Node {
+        atomic<Node*> next{nullptr};
+        optional<T> value;  // ダミーノードでは空
+
+        Node() = default;
+        explicit Node(T v) : value(move(v)) {}
+    };
+
+public:
+    // 走査用のイテレータ（スナップショットの寿命の中でだけ有効）
+    class ConstIterator {
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator(const Node* node = nullptr) : node_(node) {}
+
+        reference operator*() const { return *node_->value; }
+        pointer operator->() const { return &*node_->value; }
+
+        ConstIterator& operator++() {
+            node_ = node_->next.load(memory_order_acquire);
+            return *this;
+        }
+
+        ConstIterator operator++(int) {
+            ConstIterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        bool operator==(const ConstIterator& other) const { return node_ == other.node_; }
+        bool operator!=(const ConstIterator& other) const { return node_ != other.node_; }
+
+    private:
+        const Node* node_;
+    };
+
+    // ガードを持ったまま begin / end を提供する。作ったスレッドの中で使うこと
+    class Snapshot {
+    public:
+        ConstIterator begin() const { return ConstIterator(first_); }
+        ConstIterator end() const { return ConstIterator(); }
+
+    private:
+        friend class ConcurrentLinkedList;
+        explicit Snapshot(const ConcurrentLinkedList& list)
+            : first_(list.head_.load(memory_order_acquire)->next.load(memory_order_acquire)) {}
+
+        EpochDomain::Guard guard_;  // first_ を読む前に登録される（メンバの宣言順）
+        const Node* first_;
+    };
+
+    ConcurrentLinkedList() {
+        Node* dummy = new Node();
+        head_.store(dummy, memory_order_relaxed);
+        tail_.store(dummy, memory_order_relaxed);
+    }
+
+    // 他のスレッドが使っていないこと
+    ~ConcurrentLinkedList() {
+        Node* node = head_.load(memory_order_relaxed);
+        while (node) {
+            Node* next = node->next.load(memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    ConcurrentLinkedList(const ConcurrentLinkedList&) = delete;
+    ConcurrentLinkedList& operator=(const ConcurrentLinkedList&) = delete;
+
+    void push_back(T value) {
+        Node* node = new Node(move(value));
+        EpochDomain::Guard guard;
+        while (true) {
+            Node* tail = tail_.load(memory_order_acquire);
+            Node* next = tail->next.load(memory_order_acquire);
+            if (tail != tail_.load(memory_order_acquire)) continue;
+
+            if (next == nullptr) {
+                if (tail->next.compare_exchange_weak(next, node, memory_order_release, memory_order_relaxed)) {
+                    // 失敗しても他のスレッドが tail を進めてくれる
+                    tail_.compare_exchange_strong(tail, node, memory_order_release, memory_order_relaxed);
+                    break;
+                }
+            } else {
+                // tail が遅れているので進めるのを手伝う
+                tail_.compare_exchange_strong(tail, next, memory_order_release, memory_order_relaxed);
+            }
+        }
+        size_.fetch_add(1, memory_order_relaxed);
+    }
+
+    optional<T> pop_front() {
+        EpochDomain::Guard guard;
+        while (true) {
+            Node* head = head_.load(memory_order_acquire);
+            Node* tail = tail_.load(memory_order_acquire);
+            Node* next = head->next.load(memory_order_acquire);
+            if (head != head_.load(memory_order_acquire)) continue;
+
+            if (next == nullptr) return nullopt;
+            if (head == tail) {
+                tail_.compare_exchange_strong(tail, next, memory_order_release, memory_order_relaxed);
+                continue;
+            }
+            if (head_.compare_exchange_weak(head, next, memory_order_acq_rel, memory_order_relaxed)) {
+                // next が新しいダミーになる。値はコピーで取り出し、ノードごと後で解放する
+                optional<T> value = next->value;
+                size_.fetch_sub(1, memory_order_relaxed);
+                EpochDomain::instance().retire(head, [](void* p) { delete static_cast<Node*>(p); });
+                return value;
+            }
+        }
+    }
+
+    bool empty() const {
+        EpochDomain::Guard guard;
+        return head_.load(memory_order_acquire)->next.load(memory_order_acquire) == nullptr;
+    }
+
+    // 同時更新中は目安の値
+    size_t size() const { return size_.load(memory_order_relaxed); }
+
+    Snapshot snapshot() const { return Snapshot(*this); }
+
+    vector<T> to_vector() const {
+        vector<T> result;
+        for (const T& value : snapshot()) result.push_back(value);
+        return result;
+    }
+
+private:
+    alignas(64) atomic<Node*> head_;
+    alignas(64) atomic<Node*> tail_;
+    alignas(64) atomic<size_t> size_{0};
+};
+
 // === デモ ===
 void basic_operations() {
     cout << "--- Basic Operations ---" << endl;
@@ -405,6 +1146,125 @@ void copy_move_demo() {
     cout << endl;
 }
 
+void splice_demo() {
+    cout << "--- Splice and append_range ---" << endl;
+
+    LinkedList<int> a;
+    a.append_range(vector<int>{1, 2, 3});
+    LinkedList<int> b;
+    b.append_range(views::iota(4, 7));
+    a.splice_back(b);
+    cout << "append_range + splice_back: " << a << " (other now " << b << ")" << endl;
+
+    cout << endl;
+}
+
+void unrolled_demo() {
+    cout << "--- UnrolledList ---" << endl;
+    using namespace chrono;
+
+    UnrolledList<int> small;
+    for (int i = 1; i <= 5; ++i) small.push_back(i);
+    small.push_front(0);
+    cout << "UnrolledList: " << small << " (" << UnrolledList<int>::block_capacity
+         << " ints per block)" << endl;
+
+    // 100 万要素: 探索・変換・破棄を LinkedList と比べる
+    constexpr int n = 1000000;
+    auto time_us = [](auto&& f) {
+        auto start = steady_clock::now();
+        f();
+        return duration_cast<microseconds>(steady_clock::now() - start).count();
+    };
+
+    auto nodes = make_unique<LinkedList<int>>();
+    auto blocks = make_unique<UnrolledList<int>>();
+    nodes->append_range(views::iota(0, n));
+    blocks->append_range(views::iota(0, n));
+
+    bool found = false;
+    size_t copied = 0;
+    auto node_find = time_us([&] { found |= nodes->contains(-1); });
+    auto block_find = time_us([&] { found |= blocks->contains(-1); });
+    auto node_vec = time_us([&] { copied += nodes->to_vector().size(); });
+    auto block_vec = time_us([&] { copied += blocks->to_vector().size(); });
+    assert(!found && copied == 2 * size_t{n});
+    auto node_free = time_us([&] { nodes.reset(); });
+    auto block_free = time_us([&] { blocks.reset(); });
+
+    cout << n << " ints  contains(miss): LinkedList " << node_find << " us, UnrolledList "
+         << block_find << " us" << endl;
+    cout << n << " ints  to_vector:      LinkedList " << node_vec << " us, UnrolledList "
+         << block_vec << " us" << endl;
+    cout << n << " ints  destroy:        LinkedList " << node_free << " us, UnrolledList "
+         << block_free << " us" << endl;
+
+    cout << endl;
+}
+
+// producers 本のスレッドが push_back し、同じ本数のスレッドが pop_front する
+template<typename Push, typename Pop>
+long long run_producers_consumers(int producers, int per_producer, Push push, Pop pop) {
+    atomic<long long> sum{0};
+    atomic<int> remaining{producers * per_producer};
+    vector<thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; ++i) push(p * per_producer + i);
+        });
+        threads.emplace_back([&] {
+            long long local = 0;
+            while (remaining.load(memory_order_relaxed) > 0) {
+                if (auto v = pop()) {
+                    local += *v;
+                    remaining.fetch_sub(1, memory_order_relaxed);
+                } else {
+                    this_thread::yield();
+                }
+            }
+            sum.fetch_add(local);
+        });
+    }
+    for (auto& t : threads) t.join();
+    return sum.load();
+}
+
+void concurrent_demo() {
+    cout << "--- ConcurrentLinkedList ---" << endl;
+    using namespace chrono;
+
+    ConcurrentLinkedList<int> queue;
+    for (int i = 1; i <= 5; ++i) queue.push_back(i);
+    queue.pop_front();
+    cout << "Snapshot:";
+    for (int v : queue.snapshot()) cout << " " << v;
+    cout << endl;
+
+    // 外側の mutex で包んだ LinkedList との比較
+    constexpr int producers = 4;
+    constexpr int per_producer = 50000;
+    auto start = steady_clock::now();
+    LinkedList<int> locked_list;
+    mutex mtx;
+    long long locked_sum = run_producers_consumers(producers, per_producer,
+        [&](int v) { lock_guard<mutex> lock(mtx); locked_list.push_back(v); },
+        [&]() { lock_guard<mutex> lock(mtx); return locked_list.pop_front(); });
+    auto locked_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    ConcurrentLinkedList<int> lock_free;
+    long long lock_free_sum = run_producers_consumers(producers, per_producer,
+        [&](int v) { lock_free.push_back(v); },
+        [&]() { return lock_free.pop_front(); });
+    auto lock_free_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    cout << producers << "x" << per_producer << " items: mutex + LinkedList " << locked_us
+         << " us, ConcurrentLinkedList " << lock_free_us << " us (sums "
+         << (locked_sum == lock_free_sum ? "match" : "differ") << ")" << endl;
+
+    cout << endl;
+}
+
 // === テスト ===
 void run_tests() {
     cout << "--- Tests ---" << endl;
@@ -446,10 +1306,236 @@ void run_tests() {
     assert(list.contains(10) == true);
     assert(list.contains(999) == false);
 
+    // append_range / splice_back
+    LinkedList<int> other;
+    other.append_range(vector<int>{7, 8});
+    list.splice_back(other);
+    assert(list.to_vector() == vector<int>({20, 10, 2, 7, 8}));
+    assert(other.empty() && other.begin() == other.end());
+    other.push_back(9);  // 空になった側もそのまま使える
+    list.splice_back(move(other));
+    assert(list.size() == 6 && list.back()->get() == 9);
+    list.remove(9);
+    list.push_back(11);
+    assert(list.back()->get() == 11);
+
+    // 長いリストの破棄で再帰しない
+    {
+        LinkedList<int> huge;
+        huge.append_range(views::iota(0, 2000000));
+        LinkedList<int> moved_over;
+        moved_over.push_back(1);
+        moved_over = move(huge);
+        assert(moved_over.size() == 2000000);
+    }
+
+    // UnrolledList: LinkedList と同じ操作で同じ結果になる
+    using Small = UnrolledList<int, 32>;  // 1 ブロック 4 要素にしてブロック境界を踏ませる
+    static_assert(Small::block_capacity == 4);
+    Small ul;
+    assert(ul.empty() && ul.begin() == ul.end());
+    for (int i = 1; i <= 10; ++i) ul.push_back(i);
+    for (int i = 0; i >= -5; --i) ul.push_front(i);
+    vector<int> expected;
+    for (int i = -5; i <= 10; ++i) expected.push_back(i);
+    assert(ul.to_vector() == expected);
+    assert(ul.size() == 16);
+    assert(ul.front()->get() == -5 && ul.back()->get() == 10);
+
+    assert(ul.pop_front() == -5);
+    assert(ul.remove(4) && ul.remove(10) && ul.remove(-4));
+    assert(!ul.remove(42));
+    assert(ul.back()->get() == 9);
+    expected = {-3, -2, -1, 0, 1, 2, 3, 5, 6, 7, 8, 9};
+    assert(ul.to_vector() == expected);
+    assert(ul.contains(7) && !ul.contains(4));
+
+    ul.reverse();
+    assert(ul.to_vector() == vector<int>(expected.rbegin(), expected.rend()));
+    assert(ul.front()->get() == 9 && ul.back()->get() == -3);
+    ul.push_back(100);
+    assert(ul.back()->get() == 100);
+
+    int sum = 0;
+    for (int& v : ul) v *= 2;
+    for (const int& v : static_cast<const Small&>(ul)) sum += v;
+    assert(sum == 2 * (35 + 100));
+
+    Small copy = ul;
+    Small tail;
+    tail.append_range(vector<int>{-1, -2});
+    copy.splice_back(tail);
+    assert(copy.size() == ul.size() + 2 && tail.empty());
+    assert(copy.back()->get() == -2);
+    Small moved = move(copy);
+    assert(copy.empty() && moved.size() == ul.size() + 2);
+
+    while (!moved.empty()) moved.pop_front();
+    assert(moved.begin() == moved.end() && !moved.back());
+    moved.push_front(1);
+    assert(moved.to_vector() == vector<int>({1}));
+
+    // 非トリビアルな要素型
+    UnrolledList<string, 64> words;
+    words.append_range(vector<string>{"a", "long enough to allocate on the heap", "c"});
+    words.push_front("z");
+    assert(words.remove("a"));
+    assert(words.to_vector() == vector<string>({"z", "long enough to allocate on the heap", "c"}));
+    assert(words.pop_front() == "z");
+
+    // 新しいブロックを作るときも右辺値はムーブする（ムーブしかできない型も入る）
+    UnrolledList<unique_ptr<int>, 32> owners;
+    for (int i = 0; i < 10; ++i) owners.push_back(make_unique<int>(i));
+    assert(owners.size() == 10 && **owners.pop_front() == 0);
+    string heavy = "long enough to allocate on the heap";
+    UnrolledList<string, 64> fresh;
+    fresh.emplace_back(move(heavy));
+    assert(heavy.empty() && fresh.pop_front() == "long enough to allocate on the heap");
+
+    // ConcurrentLinkedList: 単一スレッドでは普通のキュー
+    ConcurrentLinkedList<string> cq;
+    assert(cq.empty() && !cq.pop_front());
+    cq.push_back("a");
+    cq.push_back("b");
+    cq.push_back("c");
+    assert(cq.size() == 3);
+    assert(cq.pop_front() == "a");
+    assert(cq.to_vector() == vector<string>({"b", "c"}));
+    {
+        auto snap = cq.snapshot();
+        assert(cq.pop_front() == "b");  // スナップショット中に pop してもノードは生きている
+        vector<string> seen(snap.begin(), snap.end());
+        assert(seen == vector<string>({"b", "c"}));
+    }
+    assert(cq.pop_front() == "c");
+    assert(cq.empty() && !cq.pop_front());
+
+    // 複数スレッド: 要素の欠落・重複がなく、生産者ごとの順序が保たれる
+    {
+        constexpr int producers = 4;
+        constexpr int per_producer = 20000;
+        ConcurrentLinkedList<int> mt;
+        atomic<int> popped{0};
+        atomic<bool> order_ok{true};
+        atomic<long long> sum{0};
+        vector<thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&mt, p] {
+                for (int i = 0; i < per_producer; ++i) mt.push_back(p * per_producer + i);
+            });
+            threads.emplace_back([&] {
+                vector<int> last(producers, -1);
+                long long local = 0;
+                while (popped.load() < producers * per_producer) {
+                    auto v = mt.pop_front();
+                    if (!v) continue;
+                    popped.fetch_add(1);
+                    int producer = *v / per_producer;
+                    if (*v <= last[producer]) order_ok = false;
+                    last[producer] = *v;
+                    local += *v;
+                }
+                sum.fetch_add(local);
+            });
+        }
+        // 走査しながら pop されても壊れない
+        threads.emplace_back([&] {
+            while (popped.load() < producers * per_producer) {
+                size_t count = 0;
+                for (int v : mt.snapshot()) count += v >= 0;
+                (void)count;
+            }
+        });
+        for (auto& t : threads) t.join();
+
+        long long n = producers * per_producer;
+        assert(order_ok);
+        assert(sum == n * (n - 1) / 2);
+        assert(mt.empty() && mt.size() == 0);
+    }
+
     cout << "All tests passed!" << endl;
 }
 
-int main() {
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+// LinkedList / UnrolledList を std::list / std::vector と同じ操作で比べる。
+// 構築 (push_back N 件 + 破棄)、走査、見つからない値の探索
+template<typename C>
+void bench_sequence(bench::Runner& runner, const string& container, size_t count) {
+    string suffix = "/" + container + "/" + to_string(count);
+    double items = static_cast<double>(count);
+
+    runner.run("build" + suffix, items, "elem", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            C c;
+            for (size_t v = 0; v < count; ++v) c.push_back(static_cast<int>(v));
+            bench::keep(c);
+        }
+    });
+
+    C c;
+    for (size_t v = 0; v < count; ++v) c.push_back(static_cast<int>(v));
+
+    runner.run("iterate" + suffix, items, "elem", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            long long sum = 0;
+            for (int v : c) sum += v;
+            bench::keep(sum);
+        }
+    });
+
+    runner.run("find_miss" + suffix, items, "elem", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            if constexpr (requires { c.contains(-1); }) {
+                bench::keep(c.contains(-1));
+            } else {
+                bench::keep(find(c.begin(), c.end(), -1) != c.end());
+            }
+        }
+    });
+}
+
+// 要素数を一定に保ったまま push_back + pop_front を繰り返す（キューとしての使い方）
+template<typename C>
+void bench_queue(bench::Runner& runner, const string& container, size_t depth) {
+    runner.run("queue/" + container + "/" + to_string(depth), 1, "op", [&](uint64_t n) {
+        C c;
+        for (size_t v = 0; v < depth; ++v) c.push_back(static_cast<int>(v));
+        for (uint64_t i = 0; i < n; ++i) {
+            c.push_back(static_cast<int>(i));
+            c.pop_front();
+        }
+        bench::keep(c);
+    });
+}
+
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("linked_list", options);
+
+    for (size_t count : {size_t{1000}, size_t{100000}}) {
+        bench_sequence<LinkedList<int>>(runner, "LinkedList", count);
+        bench_sequence<UnrolledList<int>>(runner, "UnrolledList", count);
+        bench_sequence<list<int>>(runner, "std::list", count);
+        bench_sequence<vector<int>>(runner, "std::vector", count);
+    }
+
+    // vector には pop_front がないので std::deque と比べる
+    bench_queue<LinkedList<int>>(runner, "LinkedList", 1000);
+    bench_queue<UnrolledList<int>>(runner, "UnrolledList", 1000);
+    bench_queue<ConcurrentLinkedList<int>>(runner, "ConcurrentLinkedList", 1000);
+    bench_queue<list<int>>(runner, "std::list", 1000);
+    bench_queue<deque<int>>(runner, "std::deque", 1000);
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        return 0;
+    }
+
     cout << "=== LinkedList Demo ===" << endl << endl;
 
     basic_operations();
@@ -457,6 +1543,9 @@ int main() {
     iteration_demo();
     reverse_demo();
     copy_move_demo();
+    splice_demo();
+    unrolled_demo();
+    concurrent_demo();
     run_tests();
 
     return 0;
@@ -1,231 +1,1875 @@
-// HTTP Server - C++ 実装 (POSIX sockets)
+// HTTP Server - C++ 実装 (POSIX sockets + epoll)
 
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <sstream>
 #include <map>
+#include <unordered_map>
+#include <deque>
 #include <vector>
 #include <functional>
-#include <regex>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <coroutine>
+#include <utility>
+#include <optional>
+#include <new>
+#include <exception>
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <bit>
+#include <string_view>
+#include <charconv>
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cerrno>
+#include <csignal>
 #include <unistd.h>
+#include <fcntl.h>
+#include <strings.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#else
+#include <poll.h>
+#endif
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 
-// === Request ===
-struct Request {
-    string method;
-    string path;
-    map<string, string> headers;
-    string body;
-    map<string, string> path_params;
-    map<string, string> query_params;
-
-    static Request parse(const string& raw) {
-        Request req;
-        istringstream stream(raw);
-        string line;
-
-        // リクエストライン
-        if (getline(stream, line)) {
-            istringstream request_line(line);
-            request_line >> req.method >> req.path;
-        }
-
-        // クエリパラメータを解析
-        auto query_pos = req.path.find('?');
-        if (query_pos != string::npos) {
-            string query_string = req.path.substr(query_pos + 1);
-            req.path = req.path.substr(0, query_pos);
-
-            istringstream query_stream(query_string);
-            string pair;
-            while (getline(query_stream, pair, '&')) {
-                auto eq_pos = pair.find('=');
-                if (eq_pos != string::npos) {
-                    req.query_params[pair.substr(0, eq_pos)] =
-                        pair.substr(eq_pos + 1);
+// ASCII の大文字小文字を無視して比較
+bool iequals(string_view a, string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// === Request ===
+// method/path/version/headers/body は接続バッファを指す string_view。
+// 参照先はハンドラの実行が終わるまで有効。
+// コンテナのノードは接続ごとのアリーナから確保し、リクエスト完了時にまとめて解放する。
+struct Request {
+    using Params = pmr::map<string_view, string_view, less<>>;
+
+    string_view method;
+    string_view path;
+    string_view version;
+    pmr::vector<pair<string_view, string_view>> headers;
+    string_view body;
+    Params path_params;    // 値はパスを指すビュー
+    Params query_params;   // キーも値もリクエストラインを指すビュー
+
+    explicit Request(pmr::memory_resource* resource = pmr::get_default_resource())
+        : headers(resource), path_params(resource), query_params(resource) {}
+
+    // ヘッダー名は大文字小文字を区別しない
+    string_view header(string_view name) const {
+        for (const auto& [key, value] : headers) {
+            if (iequals(key, name)) return value;
+        }
+        return {};
+    }
+
+    // HTTP/1.1 はデフォルトで持続接続、HTTP/1.0 は明示された場合のみ
+    bool keep_alive() const {
+        string_view connection = header("connection");
+        if (version == "HTTP/1.0") return iequals(connection, "keep-alive");
+        return !iequals(connection, "close");
+    }
+};
+
+// === RequestParser ===
+// 接続バッファ上で動く再開可能なパーサー。
+// 途中まで届いたリクエストは位置だけ覚えておき、次の read の後に続きから解析する。
+// バッファは追記で再確保されうるので、完了までは string_view ではなくオフセットで保持する。
+struct RequestLimits {
+    size_t max_header_size = 8192;     // リクエストライン + ヘッダー
+    size_t max_headers = 100;
+    size_t max_body_size = 1 << 20;
+};
+
+class RequestParser {
+public:
+    enum class Result { Complete, Incomplete, Error };
+
+    RequestParser(RequestLimits limits = {}) : limits_(limits) {}
+
+    // buf はリクエストの先頭から始まる未処理データ（前回より伸びていてよい）
+    Result feed(string_view buf) {
+        base_ = buf.data();
+        while (state_ == State::RequestLine || state_ == State::Headers) {
+            const char* nl = static_cast<const char*>(
+                memchr(buf.data() + scan_, '\n', buf.size() - scan_));
+            if (!nl) {
+                scan_ = buf.size();
+                if (scan_ > limits_.max_header_size) return fail(431);
+                return Result::Incomplete;
+            }
+
+            size_t line_end = nl - buf.data();
+            size_t next = line_end + 1;
+            if (line_end > line_start_ && buf[line_end - 1] == '\r') --line_end;
+            string_view line = buf.substr(line_start_, line_end - line_start_);
+
+            if (next > limits_.max_header_size) return fail(431);
+
+            if (state_ == State::RequestLine) {
+                if (!parse_request_line(line)) return fail(400);
+                state_ = State::Headers;
+            } else if (line.empty()) {
+                header_end_ = next;
+                if (content_length_ > limits_.max_body_size) return fail(413);
+                state_ = State::Body;
+            } else if (!parse_header(line)) {
+                return fail(error_status_ ? error_status_ : 400);
+            }
+
+            line_start_ = scan_ = next;
+        }
+
+        if (state_ == State::Body) {
+            if (buf.size() < header_end_ + content_length_) return Result::Incomplete;
+            state_ = State::Complete;
+        }
+
+        return state_ == State::Complete ? Result::Complete : Result::Error;
+    }
+
+    // Complete の後に呼ぶ。フィールドは buf を指すビューになる
+    Request request(string_view buf,
+                    pmr::memory_resource* resource = pmr::get_default_resource()) const {
+        Request req(resource);
+        req.method = slice(buf, method_);
+        req.version = slice(buf, version_);
+        req.body = buf.substr(header_end_, content_length_);
+
+        string_view target = slice(buf, target_);
+        size_t query_pos = target.find('?');
+        req.path = target.substr(0, query_pos);
+        if (query_pos != string_view::npos) {
+            parse_query(target.substr(query_pos + 1), req.query_params);
+        }
+
+        req.headers.reserve(headers_.size());
+        for (const auto& [key, value] : headers_) {
+            req.headers.emplace_back(slice(buf, key), slice(buf, value));
+        }
+        return req;
+    }
+
+    // 完了したリクエストのバイト数（パイプラインの次のリクエストはここから始まる）
+    size_t consumed() const { return header_end_ + content_length_; }
+
+    int error_status() const { return error_status_; }
+
+    // 次のリクエストに備えて状態を戻す（headers_ の容量は再利用）
+    void reset() {
+        state_ = State::RequestLine;
+        scan_ = line_start_ = header_end_ = content_length_ = 0;
+        error_status_ = 0;
+        headers_.clear();
+    }
+
+private:
+    enum class State { RequestLine, Headers, Body, Complete, Error };
+
+    // buf 内の [offset, offset + length)
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    static string_view slice(string_view buf, Span span) {
+        return buf.substr(span.offset, span.length);
+    }
+
+    Span span_of(string_view part) const {
+        return {static_cast<size_t>(part.data() - base_), part.size()};
+    }
+
+    Result fail(int status) {
+        state_ = State::Error;
+        error_status_ = status;
+        return Result::Error;
+    }
+
+    // "METHOD SP target SP HTTP/x.y"
+    bool parse_request_line(string_view line) {
+        size_t sp1 = line.find(' ');
+        size_t sp2 = line.find(' ', sp1 + 1);
+        if (sp1 == string_view::npos || sp2 == string_view::npos || sp1 == 0 ||
+            sp2 == sp1 + 1) {
+            return false;
+        }
+        string_view version = line.substr(sp2 + 1);
+        if (version.substr(0, 5) != "HTTP/") return false;
+
+        method_ = span_of(line.substr(0, sp1));
+        target_ = span_of(line.substr(sp1 + 1, sp2 - sp1 - 1));
+        version_ = span_of(version);
+        return true;
+    }
+
+    // "Name: value"（値の前後の空白は除く）
+    bool parse_header(string_view line) {
+        size_t colon = line.find(':');
+        if (colon == string_view::npos || colon == 0) return false;
+
+        string_view key = line.substr(0, colon);
+        if (key.find_first_of(" \t") != string_view::npos) return false;
+
+        string_view value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+
+        if (headers_.size() >= limits_.max_headers) {
+            error_status_ = 431;
+            return false;
+        }
+
+        if (iequals(key, "content-length")) {
+            auto [ptr, ec] = from_chars(value.data(), value.data() + value.size(),
+                                        content_length_);
+            if (ec != errc() || ptr != value.data() + value.size()) return false;
+        } else if (iequals(key, "transfer-encoding")) {
+            // chunked 転送は未対応
+            error_status_ = 501;
+            return false;
+        }
+
+        headers_.push_back({span_of(key), span_of(value)});
+        return true;
+    }
+
+    static void parse_query(string_view query, Request::Params& params) {
+        while (!query.empty()) {
+            size_t amp = query.find('&');
+            string_view pair = query.substr(0, amp);
+            size_t eq_pos = pair.find('=');
+            if (eq_pos != string_view::npos) {
+                params[pair.substr(0, eq_pos)] = pair.substr(eq_pos + 1);
+            }
+            if (amp == string_view::npos) break;
+            query.remove_prefix(amp + 1);
+        }
+    }
+
+    RequestLimits limits_;
+    State state_ = State::RequestLine;
+    const char* base_ = nullptr;   // 現在の feed() でのバッファ先頭
+    size_t scan_ = 0;              // 改行を探し始める位置
+    size_t line_start_ = 0;        // 解析中の行の先頭
+    size_t header_end_ = 0;        // ボディの開始位置
+    size_t content_length_ = 0;
+    int error_status_ = 0;
+    Span method_, target_, version_;
+    vector<pair<Span, Span>> headers_;
+};
+
+// === OutputQueue ===
+// 送信待ちデータ。status line・ヘッダー・ボディを別々のバッファのまま並べ、
+// writev でまとめて送る（連結コピーしない）。ファイルは sendfile で送る。
+class OutputQueue {
+public:
+    enum class Status { Done, WouldBlock, Error };
+
+    OutputQueue() = default;
+    OutputQueue(const OutputQueue&) = delete;
+    OutputQueue& operator=(const OutputQueue&) = delete;
+
+    ~OutputQueue() {
+        while (!segments_.empty()) pop();
+    }
+
+    // 静的な寿命を持つ文字列（キャッシュ済みの status line など）
+    void push_static(string_view data) {
+        if (data.empty()) return;
+        segments_.emplace_back().data = data;
+    }
+
+    void push(string data) {
+        if (data.empty()) return;
+        Segment& seg = segments_.emplace_back();
+        seg.owned = move(data);
+        seg.data = seg.owned;  // deque の要素は push_back/pop_front で移動しない
+    }
+
+    // fd の所有権を受け取り、送信完了時に close する
+    void push_file(int file_fd, size_t size) {
+        Segment& seg = segments_.emplace_back();
+        seg.file_fd = file_fd;
+        seg.remaining = size;
+    }
+
+    bool empty() const { return segments_.empty(); }
+
+    // 送れるだけ送る。短い書き込みは続きから再開する。sent に送信バイト数を足す
+    Status flush(int fd, size_t& sent) {
+        while (!segments_.empty()) {
+            if (segments_.front().file_fd >= 0) {
+                Status status = send_file(fd, segments_.front(), sent);
+                if (status != Status::Done) return status;
+                pop();
+                continue;
+            }
+
+            iovec iov[64];
+            int count = 0;
+            for (const auto& seg : segments_) {
+                if (seg.file_fd >= 0 || count == 64) break;
+                iov[count++] = {const_cast<char*>(seg.data.data()), seg.data.size()};
+            }
+
+            ssize_t written = writev(fd, iov, count);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return Status::WouldBlock;
+                return Status::Error;
+            }
+            sent += written;
+            consume(written);
+        }
+        return Status::Done;
+    }
+
+private:
+    struct Segment {
+        string owned;
+        string_view data;
+        int file_fd = -1;
+        off_t offset = 0;
+        size_t remaining = 0;
+    };
+
+    void pop() {
+        if (segments_.front().file_fd >= 0) close(segments_.front().file_fd);
+        segments_.pop_front();
+    }
+
+    void consume(size_t written) {
+        while (written > 0) {
+            Segment& seg = segments_.front();
+            size_t n = min(written, seg.data.size());
+            seg.data.remove_prefix(n);
+            written -= n;
+            if (seg.data.empty()) pop();
+        }
+    }
+
+    static Status send_file(int fd, Segment& seg, size_t& sent) {
+        while (seg.remaining > 0) {
+#if defined(__linux__)
+            ssize_t n = sendfile(fd, seg.file_fd, &seg.offset, seg.remaining);
+#else
+            char buffer[65536];
+            ssize_t r = pread(seg.file_fd, buffer, min(sizeof(buffer), seg.remaining), seg.offset);
+            ssize_t n = r > 0 ? write(fd, buffer, r) : r;
+            if (n > 0) seg.offset += n;
+#endif
+            if (n > 0) {
+                seg.remaining -= n;
+                sent += n;
+            } else if (n == 0) {
+                return Status::Error;  // 送信中にファイルが縮んだ
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return Status::WouldBlock;
+            } else {
+                return Status::Error;
+            }
+        }
+        return Status::Done;
+    }
+
+    deque<Segment> segments_;
+};
+
+// === Response ===
+class Response {
+public:
+    int status = 200;
+    string_view content_type;     // 静的な文字列を指す（確保なし）
+    map<string, string> headers;  // その他の追加ヘッダー
+    string body;
+    string file_path;   // 空でなければ body の代わりにこのファイルを送る
+
+    static const map<int, string> status_messages;
+
+    // ボディは値で受け取って move する（一時文字列ならコピーなし）
+    Response& text(string content) {
+        content_type = "text/plain; charset=utf-8";
+        body = move(content);
+        return *this;
+    }
+
+    Response& html(string content) {
+        content_type = "text/html; charset=utf-8";
+        body = move(content);
+        return *this;
+    }
+
+    Response& json(string content) {
+        content_type = "application/json; charset=utf-8";
+        body = move(content);
+        return *this;
+    }
+
+    // 送信時に開いて sendfile する。開けなければ 404 になる
+    Response& file(string path) {
+        content_type = content_type_for(path);
+        file_path = move(path);
+        return *this;
+    }
+
+    Response& set_status(int code) {
+        status = code;
+        return *this;
+    }
+
+    // "HTTP/1.1 200 OK\r\n" はステータスごとに一度だけ組み立ててキャッシュする
+    static string_view status_line(int status) {
+        static const vector<string> lines = [] {
+            vector<string> result(600);
+            for (int code = 100; code < 600; ++code) {
+                string message = "OK";
+                if (auto it = status_messages.find(code); it != status_messages.end()) {
+                    message = it->second;
+                }
+                result[code] = "HTTP/1.1 " + std::to_string(code) + " " + message + "\r\n";
+            }
+            return result;
+        }();
+        return lines[status >= 100 && status < 600 ? status : 500];
+    }
+
+    // status line の後ろから空行までのヘッダー部分
+    string header_block(size_t content_length, bool keep_alive) const {
+        string out;
+        out.reserve(96 + headers.size() * 48);
+        if (!content_type.empty()) {
+            out += "Content-Type: ";
+            out += content_type;
+            out += "\r\n";
+        }
+        for (const auto& [key, value] : headers) {
+            out += key;
+            out += ": ";
+            out += value;
+            out += "\r\n";
+        }
+        out += "Content-Length: ";
+        out += std::to_string(content_length);
+        out += keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        return out;
+    }
+
+    // status line / ヘッダー / ボディを別々のバッファとして送信キューに積む
+    void write_to(OutputQueue& out, bool keep_alive) {
+        if (!file_path.empty()) {
+            int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat st{};
+            if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                out.push_static(status_line(status));
+                out.push(header_block(st.st_size, keep_alive));
+                out.push_file(fd, st.st_size);
+                return;
+            }
+            if (fd >= 0) close(fd);
+            *this = Response();
+            set_status(404).text("Not Found");
+        }
+
+        out.push_static(status_line(status));
+        out.push(header_block(body.size(), keep_alive));
+        out.push(move(body));
+    }
+
+    string to_string(bool keep_alive = false) const {
+        string out(status_line(status));
+        out += header_block(body.size(), keep_alive);
+        out += body;
+        return out;
+    }
+
+private:
+    static string_view content_type_for(string_view path) {
+        static const map<string, string, less<>> types = {
+            {".html", "text/html; charset=utf-8"},
+            {".css", "text/css; charset=utf-8"},
+            {".js", "application/javascript; charset=utf-8"},
+            {".json", "application/json; charset=utf-8"},
+            {".png", "image/png"},
+            {".jpg", "image/jpeg"},
+            {".svg", "image/svg+xml"},
+        };
+        size_t dot = path.rfind('.');
+        if (dot != string_view::npos) {
+            if (auto it = types.find(path.substr(dot)); it != types.end()) return it->second;
+        }
+        return "text/plain; charset=utf-8";
+    }
+};
+
+const map<int, string> Response::status_messages = {
+    {200, "OK"},
+    {201, "Created"},
+    {400, "Bad Request"},
+    {404, "Not Found"},
+    {405, "Method Not Allowed"},
+    {413, "Payload Too Large"},
+    {431, "Request Header Fields Too Large"},
+    {500, "Internal Server Error"},
+    {501, "Not Implemented"}
+};
+
+// === Task ===
+// 非同期ハンドラ用のコルーチン型。生成時には走らず、start() か co_await で開始する。
+// 完了すると co_await していた呼び出し元へ対称転送で戻る（トップレベルなら停止）。
+template<typename T>
+class Task {
+public:
+    struct promise_type {
+        optional<T> value;
+        exception_ptr error;
+        coroutine_handle<> continuation;
+
+        Task get_return_object() {
+            return Task(coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                coroutine_handle<> await_suspend(coroutine_handle<promise_type> h) noexcept {
+                    auto next = h.promise().continuation;
+                    return next ? next : noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_value(T v) { value = move(v); }
+        void unhandled_exception() { error = current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(exchange(other.handle_, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    // co_await task: 子タスクを開始し、完了したら呼び出し元を再開する
+    bool await_ready() const noexcept { return false; }
+
+    coroutine_handle<> await_suspend(coroutine_handle<> caller) noexcept {
+        handle_.promise().continuation = caller;
+        return handle_;
+    }
+
+    T await_resume() { return take(); }
+
+    // トップレベルのタスクをイベントループから動かす
+    void start() { handle_.resume(); }
+    bool done() const { return handle_.done(); }
+
+    // 結果を取り出す（ハンドラ内の例外はここで再送出される）
+    T take() {
+        auto& promise = handle_.promise();
+        if (promise.error) rethrow_exception(promise.error);
+        return move(*promise.value);
+    }
+
+private:
+    explicit Task(coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    coroutine_handle<promise_type> handle_;
+};
+
+// === Metrics ===
+// ホットパスではロックを取らず、relaxed な atomic に加算するだけ。
+// 集計と整形は /metrics を読んだときにだけ行う。
+
+// HDR 風の対数線形ヒストグラム（1 オクターブを 8 分割、相対誤差は約 12% 以内）
+class LatencyHistogram {
+public:
+    static constexpr int sub_bits = 3;
+    static constexpr int bucket_count = (61 << sub_bits) + (1 << sub_bits);
+
+    void record(chrono::nanoseconds elapsed) {
+        uint64_t ns = max<int64_t>(elapsed.count(), 0);
+        buckets_[index(ns)].fetch_add(1, memory_order_relaxed);
+        count_.fetch_add(1, memory_order_relaxed);
+        sum_ns_.fetch_add(ns, memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(memory_order_relaxed); }
+    uint64_t sum_ns() const { return sum_ns_.load(memory_order_relaxed); }
+
+    // q (0..1) 分位点の近似値（ナノ秒）
+    uint64_t quantile(double q) const {
+        uint64_t total = 0;
+        for (const auto& b : buckets_) total += b.load(memory_order_relaxed);
+        if (total == 0) return 0;
+
+        uint64_t target = max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < bucket_count; ++i) {
+            seen += buckets_[i].load(memory_order_relaxed);
+            if (seen >= target) return midpoint(i);
+        }
+        return midpoint(bucket_count - 1);
+    }
+
+private:
+    // 小さい値はそのまま、それ以降は最上位ビットの位置 + 続く sub_bits ビットで分類
+    static int index(uint64_t v) {
+        if (v < (1u << sub_bits)) return static_cast<int>(v);
+        int msb = 63 - countl_zero(v);
+        int shift = msb - sub_bits;
+        int sub = static_cast<int>((v >> shift) & ((1u << sub_bits) - 1));
+        return ((shift + 1) << sub_bits) + sub;
+    }
+
+    static uint64_t midpoint(int i) {
+        if (i < (1 << sub_bits)) return i;
+        int shift = (i >> sub_bits) - 1;
+        uint64_t lower = static_cast<uint64_t>((1 << sub_bits) + (i & ((1 << sub_bits) - 1))) << shift;
+        return lower + ((uint64_t{1} << shift) >> 1);
+    }
+
+    array<atomic<uint64_t>, bucket_count> buckets_{};
+    atomic<uint64_t> count_{0};
+    atomic<uint64_t> sum_ns_{0};
+};
+
+// ルートごとの統計（Router がルート登録時に作り、Route から指す）
+struct alignas(64) RouteStats {
+    string method;
+    string pattern;
+    atomic<uint64_t> requests{0};
+    atomic<uint64_t> server_errors{0};   // 5xx
+    LatencyHistogram handler_latency;
+
+    RouteStats(string m, string p) : method(move(m)), pattern(move(p)) {}
+
+    void record(int status, chrono::nanoseconds elapsed) {
+        requests.fetch_add(1, memory_order_relaxed);
+        if (status >= 500) server_errors.fetch_add(1, memory_order_relaxed);
+        handler_latency.record(elapsed);
+    }
+};
+
+// サーバー全体の統計（全ワーカーで共有）
+struct ServerMetrics {
+    alignas(64) LatencyHistogram parse;
+    alignas(64) LatencyHistogram route;
+    alignas(64) LatencyHistogram write;
+    alignas(64) atomic<uint64_t> bytes_in{0};
+    alignas(64) atomic<uint64_t> bytes_out{0};
+    alignas(64) atomic<uint64_t> connections_accepted{0};
+    atomic<int64_t> connections_open{0};
+    RouteStats unmatched{"", "(unmatched)"};
+
+    // Prometheus テキスト形式で書き出す
+    string render(const vector<unique_ptr<RouteStats>>& routes) const {
+        ostringstream oss;
+        auto seconds = [](uint64_t ns) { return ns / 1e9; };
+        auto summary = [&](const string& labels, const LatencyHistogram& h, const string& name) {
+            for (double q : {0.5, 0.9, 0.99, 0.999}) {
+                oss << name << "{" << labels << (labels.empty() ? "" : ",")
+                    << "quantile=\"" << q << "\"} " << seconds(h.quantile(q)) << "\n";
+            }
+            oss << name << "_sum{" << labels << "} " << seconds(h.sum_ns()) << "\n";
+            oss << name << "_count{" << labels << "} " << h.count() << "\n";
+        };
+        auto route_labels = [](const RouteStats& r) {
+            string escaped;
+            for (char c : r.pattern) {
+                if (c == '"' || c == '\\') escaped += '\\';
+                escaped += c;
+            }
+            return "method=\"" + r.method + "\",route=\"" + escaped + "\"";
+        };
+
+        oss << "# HELP http_request_stage_seconds Time spent in each request stage\n";
+        oss << "# TYPE http_request_stage_seconds summary\n";
+        summary("stage=\"parse\"", parse, "http_request_stage_seconds");
+        summary("stage=\"route\"", route, "http_request_stage_seconds");
+        summary("stage=\"write\"", write, "http_request_stage_seconds");
+
+        vector<const RouteStats*> all;
+        for (const auto& r : routes) all.push_back(r.get());
+        all.push_back(&unmatched);
+
+        oss << "# HELP http_handler_duration_seconds Handler latency per route\n";
+        oss << "# TYPE http_handler_duration_seconds summary\n";
+        for (const RouteStats* r : all) {
+            summary(route_labels(*r), r->handler_latency, "http_handler_duration_seconds");
+        }
+
+        oss << "# HELP http_requests_total Requests per route\n";
+        oss << "# TYPE http_requests_total counter\n";
+        for (const RouteStats* r : all) {
+            oss << "http_requests_total{" << route_labels(*r) << "} "
+                << r->requests.load(memory_order_relaxed) << "\n";
+        }
+
+        oss << "# HELP http_server_errors_total 5xx responses per route\n";
+        oss << "# TYPE http_server_errors_total counter\n";
+        for (const RouteStats* r : all) {
+            oss << "http_server_errors_total{" << route_labels(*r) << "} "
+                << r->server_errors.load(memory_order_relaxed) << "\n";
+        }
+
+        oss << "# TYPE http_received_bytes_total counter\n";
+        oss << "http_received_bytes_total " << bytes_in.load(memory_order_relaxed) << "\n";
+        oss << "# TYPE http_sent_bytes_total counter\n";
+        oss << "http_sent_bytes_total " << bytes_out.load(memory_order_relaxed) << "\n";
+        oss << "# TYPE http_connections_accepted_total counter\n";
+        oss << "http_connections_accepted_total "
+            << connections_accepted.load(memory_order_relaxed) << "\n";
+        oss << "# TYPE http_open_connections gauge\n";
+        oss << "http_open_connections " << connections_open.load(memory_order_relaxed) << "\n";
+
+        return oss.str();
+    }
+};
+
+// === MpmcQueue ===
+// 有界のロックフリー MPMC キュー (concepts/concurrency の実装と同じもの)
+constexpr size_t cache_line = 64;
+constexpr int spin_limit = 128;
+
+// ブロッキング版の待ち合わせ。待っているスレッドがいなければ notify() は waiters_ を読むだけで、
+// 共有の epoch_ には書かない（try_push / try_pop の速い経路に競合する RMW を足さない）。
+// 待つ側は waiters_ で名乗ってから状態を確かめ直し、通知側は状態を変えてから waiters_ を見る。
+// 間の seq_cst フェンスで、どちらか一方は必ず相手の書き込みを見る（取りこぼさない）。
+// 1 つずつ別のキャッシュラインに置く
+class alignas(cache_line) Notifier {
+public:
+    // ready() が偽（false や空の optional）のあいだ眠って待ち、真になった値を返す
+    template<typename F>
+    auto wait_until(F ready) {
+        while (true) {
+            waiters_.fetch_add(1);
+            atomic_thread_fence(memory_order_seq_cst);
+            uint32_t seen = epoch_.load();
+            auto result = ready();
+            if (result) {
+                waiters_.fetch_sub(1);
+                return result;
+            }
+            epoch_.wait(seen);
+            waiters_.fetch_sub(1);
+        }
+    }
+
+    void notify() {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiters_.load(memory_order_relaxed) == 0) return;
+        epoch_.fetch_add(1);
+        epoch_.notify_all();
+    }
+
+private:
+    atomic<uint32_t> epoch_{0};
+    atomic<uint32_t> waiters_{0};
+};
+
+// Vyukov の有界 MPMC キュー。各セルの sequence が「このセルは何周目の push / pop を待っているか」
+// を表すので、生産者・消費者は位置の CAS 1 回でセルを確保できる
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(bit_ceil(max<size_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    ~MpmcQueue() {
+        while (try_pop()) {}
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 満杯なら false（value はそのまま残る）
+    bool try_push(T& value) {
+        size_t pos = enqueue_pos_.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(move(value));
+        cell->sequence.store(pos + 1, memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    bool try_push(T&& value) { return try_push(value); }
+
+    // 空なら nullopt
+    optional<T> try_pop() {
+        size_t pos = dequeue_pos_.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return nullopt;
+            } else {
+                pos = dequeue_pos_.load(memory_order_relaxed);
+            }
+        }
+        T* item = cell->item();
+        optional<T> result(move(*item));
+        item->~T();
+        cell->sequence.store(pos + mask_ + 1, memory_order_release);
+        not_full_.notify();
+        return result;
+    }
+
+    // ブロッキング版: 空き / 要素ができるまで待つ。眠る前に少しだけスピンする
+    void push(T value) {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (try_push(value)) return;
+        }
+        not_full_.wait_until([&] { return try_push(value); });
+    }
+
+    T pop() {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (auto item = try_pop()) return move(*item);
+        }
+        return move(*not_empty_.wait_until([&] { return try_pop(); }));
+    }
+
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* item() { return launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    const size_t mask_;
+    unique_ptr<Cell[]> cells_;
+    alignas(cache_line) atomic<size_t> enqueue_pos_{0};
+    alignas(cache_line) atomic<size_t> dequeue_pos_{0};
+    Notifier not_empty_;
+    Notifier not_full_;
+};
+
+// === AccessLog ===
+// ワーカーはループ 1 周分のログ行を自分のバッファに溜めてまとめて渡す。
+// 書き込み (write システムコール) は専用スレッドが行うので、ワーカーは I/O 待ちしない。
+// 受け渡しはロックフリーキューなので、ワーカー同士がロック待ちで並ぶこともない。
+class AccessLog {
+public:
+    explicit AccessLog(int fd = STDOUT_FILENO) : fd_(fd), writer_([this] { write_loop(); }) {}
+
+    ~AccessLog() {
+        queue_.push(string());  // 空のバッチが終了の合図
+        writer_.join();
+    }
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    // 書き込みが追いつかずキューが満杯になったときだけ待たされる
+    void submit(string batch) {
+        if (batch.empty()) return;
+        queue_.push(move(batch));
+    }
+
+private:
+    void write_loop() {
+        while (true) {
+            string batch = queue_.pop();
+            if (batch.empty()) return;
+            size_t written = 0;
+            while (written < batch.size()) {
+                ssize_t n = ::write(fd_, batch.data() + written, batch.size() - written);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                written += n;
+            }
+        }
+    }
+
+    int fd_;
+    MpmcQueue<string> queue_{1024};
+    thread writer_;
+};
+
+// === Router ===
+// ルートは登録時にセグメント単位のトライへコンパイルする。
+// マッチングはパスの長さに比例し、照合中はメモリを確保しない。
+// 優先順位は 静的セグメント > :param > *wildcard（失敗したら後戻りする）。
+using Handler = function<Response(Request&)>;
+using AsyncHandler = function<Task<Response>(Request&)>;
+
+// 登録されたハンドラ（同期・非同期のどちらか一方）
+struct Route {
+    Handler sync;
+    AsyncHandler async;
+    RouteStats* stats = nullptr;
+
+    explicit operator bool() const { return sync || async; }
+};
+
+class Router {
+public:
+    static constexpr size_t max_params = 8;
+
+    // 戻り値の型 (Response / Task<Response>) で同期・非同期のオーバーロードが選ばれる
+    void get(const string& path, Handler handler) {
+        add("GET", path, Route{move(handler), {}});
+    }
+
+    void get(const string& path, AsyncHandler handler) {
+        add("GET", path, Route{{}, move(handler)});
+    }
+
+    void post(const string& path, Handler handler) {
+        add("POST", path, Route{move(handler), {}});
+    }
+
+    void post(const string& path, AsyncHandler handler) {
+        add("POST", path, Route{{}, move(handler)});
+    }
+
+    // パターン例: "/users/:id/posts", "/static/*path"
+    void add(string_view method, string_view pattern, Route handler) {
+        if (pattern.empty() || pattern[0] != '/') {
+            throw invalid_argument("Route must start with '/': " + string(pattern));
+        }
+
+        Node* node = &table_for(method);
+        size_t param_count = 0;
+        string_view rest = pattern.substr(1);
+
+        while (true) {
+            size_t slash = rest.find('/');
+            string_view segment = rest.substr(0, slash);
+            bool last = slash == string_view::npos;
+
+            if (!segment.empty() && segment[0] == '*') {
+                if (!last) {
+                    throw invalid_argument("Wildcard must be the last segment: " + string(pattern));
+                }
+                if (++param_count > max_params) {
+                    throw invalid_argument("Too many parameters: " + string(pattern));
+                }
+                node->wildcard_name = segment.size() > 1 ? string(segment.substr(1)) : "*";
+                node->wildcard = with_stats(move(handler), method, pattern);
+                return;
+            }
+
+            if (!segment.empty() && segment[0] == ':') {
+                if (++param_count > max_params) {
+                    throw invalid_argument("Too many parameters: " + string(pattern));
+                }
+                string_view name = segment.substr(1);
+                if (!node->param) {
+                    node->param = make_unique<Node>();
+                    node->param->param_name = string(name);
+                } else if (node->param->param_name != name) {
+                    throw invalid_argument("Conflicting parameter name: " + string(pattern));
+                }
+                node = node->param.get();
+            } else {
+                node = &node->static_child(segment);
+            }
+
+            if (last) break;
+            rest.remove_prefix(slash + 1);
+        }
+
+        node->handler = with_stats(move(handler), method, pattern);
+    }
+
+    // マッチしたルートを返し、path_params を埋める（nullptr なら 404）
+    // 複数ワーカーから同時に呼ばれるので内部状態は変更しない
+    const Route* find(Request& req) const {
+        if (const Node* root = find_table(req.method);
+            root && !req.path.empty() && req.path[0] == '/') {
+            Params params;
+            if (const Route* route = match(*root, req.path.substr(1), params)) {
+                for (size_t i = 0; i < params.count; ++i) {
+                    req.path_params[params.names[i]] = params.values[i];
+                }
+                return route;
+            }
+        }
+        return nullptr;
+    }
+
+    // 登録順のルート統計（/metrics 用）
+    const vector<unique_ptr<RouteStats>>& stats() const { return stats_; }
+
+    static Response not_found(const Request& req) {
+        Response res;
+        return res.set_status(404).text("Not Found: " + string(req.path));
+    }
+
+private:
+    struct Node {
+        vector<pair<string, unique_ptr<Node>>> children;  // 静的セグメント（名前順）
+        unique_ptr<Node> param;                           // :param の子
+        string param_name;                                // この Node が :param のときの名前
+        Route handler;                                    // ここで終わるパスのハンドラ
+        Route wildcard;                                   // 残り全部にマッチするハンドラ
+        string wildcard_name;
+
+        Node& static_child(string_view segment) {
+            auto it = lower_bound(children.begin(), children.end(), segment,
+                                  [](const auto& child, string_view s) { return child.first < s; });
+            if (it == children.end() || it->first != segment) {
+                it = children.emplace(it, string(segment), make_unique<Node>());
+            }
+            return *it->second;
+        }
+
+        const Node* find_static(string_view segment) const {
+            auto it = lower_bound(children.begin(), children.end(), segment,
+                                  [](const auto& child, string_view s) { return child.first < s; });
+            return it != children.end() && it->first == segment ? it->second.get() : nullptr;
+        }
+    };
+
+    // キャプチャはパスを指すビューとして固定長配列に貯める
+    struct Params {
+        array<string_view, max_params> names;
+        array<string_view, max_params> values;
+        size_t count = 0;
+    };
+
+    // rest は先頭の '/' を除いた未照合のパス
+    static const Route* match(const Node& node, string_view rest, Params& params) {
+        size_t slash = rest.find('/');
+        string_view segment = rest.substr(0, slash);
+        bool last = slash == string_view::npos;
+        string_view tail = last ? string_view() : rest.substr(slash + 1);
+
+        auto descend = [&](const Node& child) -> const Route* {
+            if (last) return child.handler ? &child.handler : nullptr;
+            return match(child, tail, params);
+        };
+
+        if (const Node* child = node.find_static(segment)) {
+            if (const Route* route = descend(*child)) return route;
+        }
+
+        if (node.param && !segment.empty()) {
+            size_t mark = params.count;
+            params.names[params.count] = node.param->param_name;
+            params.values[params.count++] = segment;
+            if (const Route* route = descend(*node.param)) return route;
+            params.count = mark;
+        }
+
+        if (node.wildcard) {
+            params.names[params.count] = node.wildcard_name;
+            params.values[params.count++] = rest;
+            return &node.wildcard;
+        }
+
+        return nullptr;
+    }
+
+    Route with_stats(Route route, string_view method, string_view pattern) {
+        stats_.push_back(make_unique<RouteStats>(string(method), string(pattern)));
+        route.stats = stats_.back().get();
+        return route;
+    }
+
+    // メソッドは数種類しかないので線形探索で十分
+    Node& table_for(string_view method) {
+        for (auto& [name, root] : tables_) {
+            if (name == method) return *root;
+        }
+        tables_.emplace_back(string(method), make_unique<Node>());
+        return *tables_.back().second;
+    }
+
+    const Node* find_table(string_view method) const {
+        for (const auto& [name, root] : tables_) {
+            if (name == method) return root.get();
+        }
+        return nullptr;
+    }
+
+    vector<pair<string, unique_ptr<Node>>> tables_;
+    vector<unique_ptr<RouteStats>> stats_;
+};
+
+// === Poller ===
+// Linux では epoll (エッジトリガー)、それ以外では poll にフォールバック
+#if defined(__linux__)
+class Poller {
+public:
+    struct Event {
+        int fd;
+        bool readable;
+        bool writable;
+    };
+
+    Poller() : epoll_fd_(epoll_create1(0)) {}
+    ~Poller() { close(epoll_fd_); }
+
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    // 読み書き両方をエッジトリガーで登録（状態変化時のみ通知される）
+    void add(int fd) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void remove(int fd) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    // エッジトリガーでは書き込み監視を切り替える必要がない
+    void want_write(int, bool) {}
+
+    void wait(vector<Event>& events, int timeout_ms) {
+        epoll_event raw[256];
+        int n = epoll_wait(epoll_fd_, raw, 256, timeout_ms);
+        events.clear();
+        for (int i = 0; i < n; ++i) {
+            uint32_t e = raw[i].events;
+            events.push_back({
+                raw[i].data.fd,
+                (e & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0,
+                (e & (EPOLLOUT | EPOLLERR)) != 0
+            });
+        }
+    }
+
+private:
+    int epoll_fd_;
+};
+#else
+class Poller {
+public:
+    struct Event {
+        int fd;
+        bool readable;
+        bool writable;
+    };
+
+    void add(int fd) {
+        fds_.push_back({fd, POLLIN, 0});
+    }
+
+    void remove(int fd) {
+        fds_.erase(remove_if(fds_.begin(), fds_.end(),
+                             [fd](const pollfd& p) { return p.fd == fd; }),
+                   fds_.end());
+    }
+
+    // レベルトリガーなので送信待ちがあるときだけ POLLOUT を監視する
+    void want_write(int fd, bool enable) {
+        for (auto& p : fds_) {
+            if (p.fd == fd) {
+                p.events = enable ? (POLLIN | POLLOUT) : POLLIN;
+            }
+        }
+    }
+
+    void wait(vector<Event>& events, int timeout_ms) {
+        events.clear();
+        if (::poll(fds_.data(), fds_.size(), timeout_ms) <= 0) return;
+        for (const auto& p : fds_) {
+            if (p.revents == 0) continue;
+            events.push_back({
+                p.fd,
+                (p.revents & (POLLIN | POLLHUP | POLLERR)) != 0,
+                (p.revents & (POLLOUT | POLLERR)) != 0
+            });
+        }
+    }
+
+private:
+    vector<pollfd> fds_;
+};
+#endif
+
+// === RequestArena ===
+// リクエスト 1 件分の一時オブジェクト用のバンプアロケータ。
+// 最初の 4 KiB は接続内の領域から切り出し、足りなければ上流 (new) から追加する。
+// 応答をキューに積んだら release() で丸ごと巻き戻す。
+class RequestArena {
+public:
+    RequestArena() = default;
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    pmr::memory_resource* resource() { return &resource_; }
+    void release() { resource_.release(); }
+
+private:
+    alignas(max_align_t) byte initial_[4096];
+    pmr::monotonic_buffer_resource resource_{initial_, sizeof(initial_)};
+};
+
+// === ByteBuffer ===
+// 受信バッファ。read(2) で末尾に直接書き込み (prepare / commit)、処理済みの先頭は consume で詰める。
+// concepts/memory の SmallBuffer をバイト列の受信用に絞ったもの。伸長は realloc で、
+// 2 MiB を超える（大きなボディ）と mmap + mremap に切り替え、中身をコピーせずに伸ばす。
+class ByteBuffer {
+public:
+    static constexpr size_t huge_threshold = 2 << 20;
+
+    ByteBuffer() = default;
+    ByteBuffer(const ByteBuffer&) = delete;
+    ByteBuffer& operator=(const ByteBuffer&) = delete;
+
+    ~ByteBuffer() {
+        if (mapped_) {
+            munmap(data_, capacity_);
+        } else {
+            free(data_);
+        }
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    string_view view() const { return {data_, size_}; }
+
+    // 末尾に n バイト書ける領域を用意して返す。書いた分を commit() する
+    char* prepare(size_t n) {
+        if (size_ + n > capacity_) grow(size_ + n);
+        return data_ + size_;
+    }
+
+    void commit(size_t n) { size_ += n; }
+
+    // 先頭 n バイトを捨てて残りを前に詰める
+    void consume(size_t n) {
+        n = min(n, size_);
+        if (n < size_) memmove(data_, data_ + n, size_ - n);
+        size_ -= n;
+    }
+
+private:
+    void grow(size_t min_capacity) {
+        size_t capacity = max(min_capacity, capacity_ * 2);
+        if (capacity >= huge_threshold) {
+            size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            capacity = (capacity + page - 1) / page * page;
+            void* p;
+            if (mapped_) {
+                p = mremap(data_, capacity_, capacity, MREMAP_MAYMOVE);
+            } else {
+                p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p != MAP_FAILED) {
+                    if (size_) memcpy(p, data_, size_);
+                    free(data_);
+                }
+            }
+            if (p == MAP_FAILED) throw bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(p, capacity, MADV_HUGEPAGE);
+#endif
+            data_ = static_cast<char*>(p);
+            mapped_ = true;
+        } else {
+            void* p = realloc(data_, capacity);
+            if (!p) throw bad_alloc();
+            data_ = static_cast<char*>(p);
+        }
+        capacity_ = capacity;
+    }
+
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    bool mapped_ = false;
+};
+
+// === Connection ===
+// 1 クライアント分の送受信バッファ
+struct Connection {
+    int fd = -1;
+    ByteBuffer in;                  // 受信済み・未処理のデータ
+    OutputQueue out;                // 送信待ちのデータ
+    RequestParser parser;           // 解析途中のリクエストの状態
+    RequestArena arena;             // 処理中のリクエスト用の一時領域
+    size_t in_pos = 0;              // in のうち処理済みのバイト数
+    optional<Request> request;      // 非同期ハンドラが処理中のリクエスト
+    optional<Task<Response>> task;  // 実行中の非同期ハンドラ
+    bool task_keep_alive = false;
+    RouteStats* task_stats = nullptr;
+    chrono::steady_clock::time_point task_started;
+    bool peer_closed = false;       // 相手が送信側を閉じた
+    bool close_after_write = false; // 送信完了後に切断する
+    chrono::steady_clock::time_point last_active;
+};
+
+// === EventLoop ===
+// ノンブロッキングソケットを多重化するリアクター。
+// 各接続は持続接続 (keep-alive) とパイプライン化されたリクエストに対応する。
+// 非同期ハンドラはタイマーや任意の fd の準備完了を待って中断・再開できる。
+// 中断中の接続は次のリクエストを読まない（応答順と受信バッファ上のビューを守るため）。
+class EventLoop {
+public:
+    EventLoop(int listen_fd, const Router& router, ServerMetrics& metrics, AccessLog& access_log)
+        : listen_fd_(listen_fd), router_(router), metrics_(metrics), access_log_(access_log) {
+        poller_.add(listen_fd_);
+    }
+
+    ~EventLoop() {
+        for (const auto& [fd, conn] : connections_) {
+            close(fd);
+        }
+        metrics_.connections_open.fetch_sub(connections_.size(), memory_order_relaxed);
+        access_log_.submit(move(log_buffer_));
+    }
+
+    // 現在のスレッドで動いているループ（非同期ハンドラの待機登録に使う）
+    static EventLoop& current() { return *current_; }
+
+    void run() {
+        current_ = this;
+        vector<Poller::Event> events;
+        while (true) {
+            poller_.wait(events, next_timeout_ms());
+            for (const auto& ev : events) {
+                if (ev.fd == listen_fd_) {
+                    accept_clients();
+                } else if (fd_waiters_.count(ev.fd)) {
+                    wake_fd_waiter(ev);
+                } else {
+                    handle_event(ev);
                 }
             }
+            fire_timers();
+            close_idle_connections();
+            flush_access_log();
         }
+    }
+
+    // 中断中のコルーチンを時刻 / fd の準備完了まで待たせる
+    void add_timer(chrono::milliseconds delay, coroutine_handle<> handle) {
+        timers_.emplace(chrono::steady_clock::now() + delay, Waiter{handle, resuming_owner_});
+    }
+
+    void wait_fd(int fd, bool for_write, coroutine_handle<> handle) {
+        fd_waiters_[fd] = Waiter{handle, resuming_owner_, for_write};
+        poller_.add(fd);
+        if (for_write) poller_.want_write(fd, true);
+    }
+
+private:
+    static constexpr auto idle_timeout = chrono::seconds(30);
+    static constexpr auto log_flush_interval = chrono::seconds(1);
+    static constexpr size_t log_flush_size = 16384;
+    static inline thread_local EventLoop* current_ = nullptr;
+
+    struct Waiter {
+        coroutine_handle<> handle;
+        int owner;              // 待っているタスクを持つ接続の fd
+        bool for_write = false;
+    };
+
+    static bool set_nonblocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
 
-        // ヘッダー
-        while (getline(stream, line) && line != "\r" && !line.empty()) {
-            if (line.back() == '\r') line.pop_back();
-            auto colon_pos = line.find(':');
-            if (colon_pos != string::npos) {
-                string key = line.substr(0, colon_pos);
-                string value = line.substr(colon_pos + 2);
-                // ヘッダーキーを小文字に
-                transform(key.begin(), key.end(), key.begin(), ::tolower);
-                req.headers[key] = value;
+    // エッジトリガーなので EAGAIN になるまで accept し続ける
+    void accept_clients() {
+        while (true) {
+            sockaddr_in client_addr{};
+            socklen_t client_len = sizeof(client_addr);
+            int client_fd = accept(listen_fd_, (sockaddr*)&client_addr, &client_len);
+
+            if (client_fd < 0) {
+                if (errno == EINTR) continue;
+                return;  // EAGAIN または一時的なエラー
+            }
+
+            if (!set_nonblocking(client_fd)) {
+                close(client_fd);
+                continue;
             }
+
+            Connection& conn = connections_[client_fd];
+            conn.fd = client_fd;
+            conn.last_active = chrono::steady_clock::now();
+            poller_.add(client_fd);
+            metrics_.connections_accepted.fetch_add(1, memory_order_relaxed);
+            metrics_.connections_open.fetch_add(1, memory_order_relaxed);
         }
+    }
 
-        // ボディ
-        if (auto it = req.headers.find("content-length"); it != req.headers.end()) {
-            int length = stoi(it->second);
-            req.body.resize(length);
-            stream.read(&req.body[0], length);
+    void handle_event(const Poller::Event& ev) {
+        auto it = connections_.find(ev.fd);
+        if (it == connections_.end()) return;
+        Connection& conn = it->second;
+        conn.last_active = chrono::steady_clock::now();
+
+        if (ev.readable && !read_and_process(conn)) {
+            close_connection(conn.fd);
+            return;
         }
 
-        return req;
+        if (!flush(conn)) {
+            close_connection(conn.fd);
+        }
     }
-};
 
-// === Response ===
-class Response {
-public:
-    int status = 200;
-    map<string, string> headers;
-    string body;
+    // 読めるだけ読み、届いた分ずつリクエストを処理する。エラー時は false
+    // 読むたびに処理するので、受信バッファは概ね 1 リクエスト分に収まる
+    bool read_and_process(Connection& conn) {
+        constexpr size_t read_chunk = 16384;
+        while (!conn.close_after_write && !conn.task) {
+            // 受信バッファの末尾へ直接読む（一時バッファからのコピーをしない）
+            ssize_t n = read(conn.fd, conn.in.prepare(read_chunk), read_chunk);
+            if (n > 0) {
+                conn.in.commit(n);
+                metrics_.bytes_in.fetch_add(n, memory_order_relaxed);
+                process_requests(conn);
+            } else if (n == 0) {
+                // 相手が送信を終えた: 受信済みの分に応答してから切断
+                conn.peer_closed = true;
+                process_requests(conn);
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+        }
+        return true;
+    }
 
-    static const map<int, string> status_messages;
+    // バッファ内の完全なリクエストを順に処理し、応答を out に積む
+    void process_requests(Connection& conn) {
+        while (!conn.close_after_write && !conn.task) {
+            auto parse_started = chrono::steady_clock::now();
+            string_view pending = conn.in.view().substr(conn.in_pos);
+            auto result = conn.parser.feed(pending);
+            if (result == RequestParser::Result::Incomplete) break;
 
-    Response& text(const string& content) {
-        headers["Content-Type"] = "text/plain; charset=utf-8";
-        body = content;
-        return *this;
+            if (result == RequestParser::Result::Error) {
+                Response res;
+                int status = conn.parser.error_status();
+                res.set_status(status).text(Response::status_messages.at(status));
+                res.write_to(conn.out, false);
+                conn.close_after_write = true;
+                break;
+            }
+
+            size_t consumed = conn.parser.consumed();
+            bool keep_alive = false;
+            bool started_async = false;
+            Response res;
+            {
+                // req はアリーナを巻き戻す前にこのブロックで破棄する
+                Request req = conn.parser.request(pending, conn.arena.resource());
+                conn.parser.reset();
+                conn.in_pos += consumed;
+
+                auto route_started = chrono::steady_clock::now();
+                metrics_.parse.record(route_started - parse_started);
+
+                keep_alive = req.keep_alive() && !conn.peer_closed;
+                RouteStats* stats = &metrics_.unmatched;
+                auto handler_started = route_started;  // ルーティング中に投げたらそこから数える
+                try {
+                    const Route* route = router_.find(req);
+                    handler_started = chrono::steady_clock::now();
+                    metrics_.route.record(handler_started - route_started);
+                    if (route) stats = route->stats;
+
+                    if (route && route->async) {
+                        // Request とタスクは完了まで接続が持つ。in もそれまで詰めない
+                        conn.request.emplace(move(req));
+                        conn.task.emplace(route->async(*conn.request));
+                        conn.task_keep_alive = keep_alive;
+                        conn.task_stats = stats;
+                        conn.task_started = handler_started;
+                        started_async = true;
+                    } else {
+                        res = route ? route->sync(req) : Router::not_found(req);
+                    }
+                } catch (const exception& e) {
+                    res = Response();
+                    res.set_status(500).text("Internal Server Error");
+                }
+
+                if (!started_async) {
+                    stats->record(res.status, chrono::steady_clock::now() - handler_started);
+                    log_access(req, res.status);
+                }
+            }
+
+            if (started_async) {
+                // 中断せずに完了した場合はこのままループで次のリクエストへ進む
+                step_task(conn, [&] { conn.task->start(); });
+                continue;
+            }
+
+            complete_request(conn, move(res), keep_alive);
+        }
+
+        if (!conn.task) {
+            conn.in.consume(conn.in_pos);
+            conn.in_pos = 0;
+            if (conn.peer_closed) {
+                conn.close_after_write = true;
+            }
+        }
     }
 
-    Response& html(const string& content) {
-        headers["Content-Type"] = "text/html; charset=utf-8";
-        body = content;
-        return *this;
+    // Request は破棄済みなのでアリーナを巻き戻せる
+    void complete_request(Connection& conn, Response res, bool keep_alive) {
+        res.write_to(conn.out, keep_alive);
+        conn.arena.release();
+        if (!keep_alive) {
+            conn.close_after_write = true;
+        }
     }
 
-    Response& json(const string& content) {
-        headers["Content-Type"] = "application/json; charset=utf-8";
-        body = content;
-        return *this;
+    void finish_task(Connection& conn) {
+        Response res;
+        try {
+            res = conn.task->take();
+        } catch (const exception& e) {
+            res = Response();
+            res.set_status(500).text("Internal Server Error");
+        }
+        conn.task_stats->record(res.status, chrono::steady_clock::now() - conn.task_started);
+        log_access(*conn.request, res.status);
+
+        conn.task.reset();
+        conn.request.reset();
+        complete_request(conn, move(res), conn.task_keep_alive);
     }
 
-    Response& set_status(int code) {
-        status = code;
-        return *this;
+    // タスクを開始・再開する。完了していれば応答を積んで true
+    template<typename F>
+    bool step_task(Connection& conn, F&& resume) {
+        resuming_owner_ = conn.fd;
+        resume();
+        resuming_owner_ = -1;
+
+        if (!conn.task->done()) return false;
+        finish_task(conn);
+        return true;
     }
 
-    string to_string() const {
-        ostringstream oss;
+    // タイマーや fd 待ちから再開する。完了したら溜まっているリクエストの処理に戻る
+    void resume_waiter(const Waiter& waiter) {
+        auto it = connections_.find(waiter.owner);
+        if (it == connections_.end()) return;
+        Connection& conn = it->second;
 
-        string message = "OK";
-        if (auto it = status_messages.find(status); it != status_messages.end()) {
-            message = it->second;
+        if (!step_task(conn, [&] { waiter.handle.resume(); })) return;
+
+        conn.last_active = chrono::steady_clock::now();
+        process_requests(conn);
+        if (!read_and_process(conn) || !flush(conn)) {
+            close_connection(conn.fd);
         }
+    }
 
-        oss << "HTTP/1.1 " << status << " " << message << "\r\n";
+    void wake_fd_waiter(const Poller::Event& ev) {
+        auto it = fd_waiters_.find(ev.fd);
+        Waiter waiter = it->second;
+        if (waiter.for_write ? !ev.writable : !ev.readable) return;
 
-        auto headers_copy = headers;
-        headers_copy["Content-Length"] = std::to_string(body.size());
-        headers_copy["Connection"] = "close";
+        fd_waiters_.erase(it);
+        poller_.remove(ev.fd);
+        resume_waiter(waiter);
+    }
 
-        for (const auto& [key, value] : headers_copy) {
-            oss << key << ": " << value << "\r\n";
+    void fire_timers() {
+        auto now = chrono::steady_clock::now();
+        while (!timers_.empty() && timers_.begin()->first <= now) {
+            Waiter waiter = timers_.begin()->second;
+            timers_.erase(timers_.begin());
+            resume_waiter(waiter);
         }
+    }
 
-        oss << "\r\n" << body;
+    // 次のタイマーまで（最大 1 秒）。アイドル接続の掃除もこの周期で行う
+    int next_timeout_ms() const {
+        if (timers_.empty()) return 1000;
+        auto wait = chrono::duration_cast<chrono::milliseconds>(
+            timers_.begin()->first - chrono::steady_clock::now());
+        return static_cast<int>(clamp<long long>(wait.count() + 1, 0, 1000));
+    }
 
-        return oss.str();
+    // 送れるだけ送る。接続を閉じるべきときは false
+    bool flush(Connection& conn) {
+        if (conn.out.empty()) {
+            poller_.want_write(conn.fd, false);
+            return !conn.close_after_write || conn.task;
+        }
+
+        auto started = chrono::steady_clock::now();
+        size_t sent = 0;
+        auto status = conn.out.flush(conn.fd, sent);
+        metrics_.write.record(chrono::steady_clock::now() - started);
+        metrics_.bytes_out.fetch_add(sent, memory_order_relaxed);
+
+        switch (status) {
+            case OutputQueue::Status::WouldBlock:
+                // 続きはソケットが書き込み可能になったときに送る
+                poller_.want_write(conn.fd, true);
+                return true;
+            case OutputQueue::Status::Error:
+                return false;
+            case OutputQueue::Status::Done:
+                break;
+        }
+
+        poller_.want_write(conn.fd, false);
+        return !conn.close_after_write || conn.task;
     }
-};
 
-const map<int, string> Response::status_messages = {
-    {200, "OK"},
-    {201, "Created"},
-    {400, "Bad Request"},
-    {404, "Not Found"},
-    {405, "Method Not Allowed"},
-    {500, "Internal Server Error"}
-};
+    // 中断中のタスクが登録した待機を外してからフレームごと破棄する
+    void close_connection(int fd) {
+        for (auto it = timers_.begin(); it != timers_.end();) {
+            it = it->second.owner == fd ? timers_.erase(it) : next(it);
+        }
+        for (auto it = fd_waiters_.begin(); it != fd_waiters_.end();) {
+            if (it->second.owner == fd) {
+                poller_.remove(it->first);
+                it = fd_waiters_.erase(it);
+            } else {
+                ++it;
+            }
+        }
 
-// === Router ===
-using Handler = function<Response(Request&)>;
+        poller_.remove(fd);
+        close(fd);
+        connections_.erase(fd);
+        metrics_.connections_open.fetch_sub(1, memory_order_relaxed);
+    }
 
-class Router {
-public:
-    void get(const string& path, Handler handler) {
-        routes_["GET"][path] = handler;
+    // "GET /path 200" をループ内のバッファに追記するだけ（出力は AccessLog のスレッド）
+    void log_access(const Request& req, int status) {
+        log_buffer_.append(req.method);
+        log_buffer_ += ' ';
+        log_buffer_.append(req.path);
+        log_buffer_ += ' ';
+        log_buffer_ += std::to_string(status);
+        log_buffer_ += '\n';
+        if (log_buffer_.size() >= log_flush_size) {
+            access_log_.submit(move(log_buffer_));
+            log_buffer_ = string();
+            last_log_flush_ = chrono::steady_clock::now();
+        }
     }
 
-    void post(const string& path, Handler handler) {
-        routes_["POST"][path] = handler;
-    }
-
-    Response route(Request& req) {
-        // 完全一致
-        if (routes_.count(req.method) && routes_[req.method].count(req.path)) {
-            return routes_[req.method][req.path](req);
-        }
-
-        // パターンマッチ
-        if (routes_.count(req.method)) {
-            for (const auto& [pattern, handler] : routes_[req.method]) {
-                if (pattern.find(':') != string::npos) {
-                    // パターンを正規表現に変換
-                    string regex_pattern = "^" + pattern + "$";
-                    vector<string> param_names;
-
-                    // :name を (?<name>[^/]+) に変換
-                    regex param_regex(":([a-zA-Z_][a-zA-Z0-9_]*)");
-                    smatch match;
-                    string temp = pattern;
-                    while (regex_search(temp, match, param_regex)) {
-                        param_names.push_back(match[1]);
-                        temp = match.suffix();
-                    }
+    void flush_access_log() {
+        auto now = chrono::steady_clock::now();
+        if (!log_buffer_.empty() && now - last_log_flush_ >= log_flush_interval) {
+            access_log_.submit(move(log_buffer_));
+            log_buffer_ = string();
+            last_log_flush_ = now;
+        }
+    }
 
-                    regex_pattern = regex_replace(
-                        regex_pattern,
-                        param_regex,
-                        "([^/]+)"
-                    );
-
-                    regex path_regex(regex_pattern);
-                    smatch path_match;
-                    if (regex_match(req.path, path_match, path_regex)) {
-                        for (size_t i = 0; i < param_names.size(); ++i) {
-                            req.path_params[param_names[i]] = path_match[i + 1];
-                        }
-                        return handler(req);
-                    }
-                }
+    void close_idle_connections() {
+        auto now = chrono::steady_clock::now();
+        vector<int> idle;
+        for (const auto& [fd, conn] : connections_) {
+            if (!conn.task && now - conn.last_active > idle_timeout) {
+                idle.push_back(fd);
             }
         }
+        for (int fd : idle) {
+            close_connection(fd);
+        }
+    }
 
-        // 404
-        Response res;
-        return res.set_status(404).text("Not Found: " + req.path);
+    int listen_fd_;
+    const Router& router_;
+    ServerMetrics& metrics_;
+    AccessLog& access_log_;
+    string log_buffer_;
+    chrono::steady_clock::time_point last_log_flush_;
+    Poller poller_;
+    unordered_map<int, Connection> connections_;
+    multimap<chrono::steady_clock::time_point, Waiter> timers_;
+    unordered_map<int, Waiter> fd_waiters_;
+    int resuming_owner_ = -1;
+};
+
+// === 非同期ハンドラ用の awaitable ===
+// co_await sleep_for(100ms);
+struct SleepAwaiter {
+    chrono::milliseconds duration;
+
+    bool await_ready() const noexcept { return duration.count() <= 0; }
+    void await_suspend(coroutine_handle<> handle) {
+        EventLoop::current().add_timer(duration, handle);
     }
+    void await_resume() const noexcept {}
+};
 
-private:
-    map<string, map<string, Handler>> routes_;
+inline SleepAwaiter sleep_for(chrono::milliseconds duration) {
+    return {duration};
+}
+
+// co_await wait_readable(upstream_fd); （fd はノンブロッキングであること）
+struct FdAwaiter {
+    int fd;
+    bool for_write;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> handle) {
+        EventLoop::current().wait_fd(fd, for_write, handle);
+    }
+    void await_resume() const noexcept {}
 };
 
+inline FdAwaiter wait_readable(int fd) { return {fd, false}; }
+inline FdAwaiter wait_writable(int fd) { return {fd, true}; }
+
 // === HTTPServer ===
+// num_workers > 1 のときはワーカースレッドごとに SO_REUSEPORT で listen ソケットを持ち、
+// カーネルに接続を振り分けさせる（accept 用の共有ロックが不要）
 class HTTPServer {
 public:
-    HTTPServer(int port) : port_(port) {}
+    HTTPServer(int port, size_t num_workers = 1, int backlog = SOMAXCONN)
+        : port_(port), num_workers_(max<size_t>(num_workers, 1)), backlog_(backlog) {}
 
     void get(const string& path, Handler handler) {
-        router_.get(path, handler);
+        router_.get(path, move(handler));
+    }
+
+    void get(const string& path, AsyncHandler handler) {
+        router_.get(path, move(handler));
     }
 
     void post(const string& path, Handler handler) {
-        router_.post(path, handler);
+        router_.post(path, move(handler));
+    }
+
+    void post(const string& path, AsyncHandler handler) {
+        router_.post(path, move(handler));
     }
 
     void start() {
+        // 切断済みソケットへの write でプロセスが落ちないようにする
+        signal(SIGPIPE, SIG_IGN);
+
+        // 組み込みのメトリクス。ワーカーが Router を読み始める前に登録しておく
+        router_.get("/metrics", [this](Request&) {
+            Response res;
+            return res.text(metrics_.render(router_.stats()));
+        });
+
+        vector<int> listen_fds;
+        for (size_t i = 0; i < num_workers_; ++i) {
+            int fd = create_listener();
+            if (fd < 0) {
+                for (int f : listen_fds) close(f);
+                return;
+            }
+            listen_fds.push_back(fd);
+        }
+
+        cout << "Server started at http://127.0.0.1:" << port_
+             << " (" << num_workers_ << " worker(s))" << endl;
+        cout << "Try:" << endl;
+        cout << "  curl http://localhost:" << port_ << "/" << endl;
+        cout << "  curl http://localhost:" << port_ << "/hello/world" << endl;
+        cout << "  curl http://localhost:" << port_ << "/json" << endl;
+        cout << "  curl http://localhost:" << port_ << "/metrics" << endl;
+        cout << "\nPress Ctrl+C to stop\n" << endl;
+
+        // 各ワーカーは自分の listen ソケットとイベントループを持ち、Router を共有する
+        vector<thread> workers;
+        for (size_t i = 1; i < listen_fds.size(); ++i) {
+            workers.emplace_back([this, fd = listen_fds[i]]() {
+                EventLoop loop(fd, router_, metrics_, access_log_);
+                loop.run();
+            });
+        }
+
+        EventLoop loop(listen_fds[0], router_, metrics_, access_log_);
+        loop.run();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (int fd : listen_fds) {
+            close(fd);
+        }
+    }
+
+private:
+    int create_listener() {
         int server_fd = socket(AF_INET, SOCK_STREAM, 0);
         if (server_fd < 0) {
             cerr << "Failed to create socket" << endl;
-            return;
+            return -1;
         }
 
         int opt = 1;
         setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if (num_workers_ > 1 &&
+            setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            cerr << "Failed to set SO_REUSEPORT" << endl;
+            close(server_fd);
+            return -1;
+        }
 
         sockaddr_in address{};
         address.sin_family = AF_INET;
@@ -235,85 +1879,411 @@ public:
         if (bind(server_fd, (sockaddr*)&address, sizeof(address)) < 0) {
             cerr << "Failed to bind" << endl;
             close(server_fd);
-            return;
+            return -1;
         }
 
-        if (listen(server_fd, 10) < 0) {
+        if (listen(server_fd, backlog_) < 0) {
             cerr << "Failed to listen" << endl;
             close(server_fd);
-            return;
+            return -1;
         }
 
-        cout << "Server started at http://127.0.0.1:" << port_ << endl;
-        cout << "Try:" << endl;
-        cout << "  curl http://localhost:" << port_ << "/" << endl;
-        cout << "  curl http://localhost:" << port_ << "/hello/world" << endl;
-        cout << "  curl http://localhost:" << port_ << "/json" << endl;
-        cout << "\nPress Ctrl+C to stop\n" << endl;
+        int flags = fcntl(server_fd, F_GETFL, 0);
+        fcntl(server_fd, F_SETFL, flags | O_NONBLOCK);
 
-        while (true) {
-            sockaddr_in client_addr{};
-            socklen_t client_len = sizeof(client_addr);
-            int client_fd = accept(server_fd, (sockaddr*)&client_addr, &client_len);
+        return server_fd;
+    }
 
-            if (client_fd < 0) {
-                continue;
+    int port_;
+    size_t num_workers_;
+    int backlog_;
+    Router router_;
+    ServerMetrics metrics_;
+    AccessLog access_log_;
+};
+
+// === JSON ヘルパー（簡易版）===
+// 04_json_parser の JsonWriter と同じく 1 つのバッファに直接追記し、
+// '"' '\\' 制御文字をエスケープする
+inline void append_json_string(string& out, string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    out += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+        out.append(s.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xF];
+                break;
+        }
+    }
+    out.append(s.data() + start, s.size() - start);
+    out += '"';
+}
+
+template<typename Map = map<string, string>>
+string json_object(const Map& obj) {
+    string out;
+    out += '{';
+    bool first = true;
+    for (const auto& [key, value] : obj) {
+        if (!first) out += ',';
+        append_json_string(out, key);
+        out += ':';
+        append_json_string(out, value);
+        first = false;
+    }
+    out += '}';
+    return out;
+}
+
+// 非同期処理を組み合わせる例（上流への問い合わせの代わりに待つだけ）
+Task<string> slow_lookup(string key) {
+    co_await sleep_for(chrono::milliseconds(200));
+    co_return "value of " + key;
+}
+
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` でサーバーの代わりに実行する。
+// ハーネス (bench::Runner) は bench/bench.hpp
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("http_server", options);
+    RequestArena arena;
+
+    // RequestParser::feed + request()。サーバーと同じくアリーナに確保し、1 件ごとに巻き戻す
+    const string post_body = R"({"name":"widget","qty":42})";
+    const pair<string, string> requests[] = {
+        {"minimal", "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"},
+        {"browser",
+         "GET /hello/world?lang=ja&page=2 HTTP/1.1\r\n"
+         "Host: localhost:8080\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+         "Chrome/126.0 Safari/537.36\r\n"
+         "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+         "Accept-Language: ja,en-US;q=0.7,en;q=0.3\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Connection: keep-alive\r\n"
+         "Cookie: session=0123456789abcdef; theme=dark\r\n"
+         "Cache-Control: max-age=0\r\n\r\n"},
+        {"post_json",
+         "POST /api/v1/items HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+         "Content-Length: " + std::to_string(post_body.size()) + "\r\n\r\n" + post_body},
+    };
+    for (const auto& [name, raw] : requests) {
+        runner.run("parse/" + name, raw.size(), "B", [&](uint64_t n) {
+            RequestParser parser;
+            for (uint64_t i = 0; i < n; ++i) {
+                parser.reset();
+                if (parser.feed(raw) != RequestParser::Result::Complete) abort();
+                {
+                    Request req = parser.request(raw, arena.resource());
+                    bench::keep(req);
+                }
+                arena.release();
+            }
+        });
+    }
+
+    // Router::find（path_params を埋めるところまで）
+    Router router;
+    Handler ok = [](Request&) { return Response(); };
+    for (const char* pattern : {"/", "/json", "/html", "/echo", "/metrics", "/source",
+                                "/hello/:name", "/files/*path", "/static/*path",
+                                "/api/v1/users", "/api/v1/users/:id", "/api/v1/users/:id/posts",
+                                "/api/v1/users/:id/posts/:post", "/api/v1/items",
+                                "/api/v1/items/:id", "/api/v2/search"}) {
+        router.get(pattern, ok);
+    }
+    const pair<string, string> paths[] = {
+        {"static", "/json"},
+        {"param", "/hello/world"},
+        {"nested_params", "/api/v1/users/42/posts/7"},
+        {"wildcard", "/files/css/site/main.css"},
+        {"miss", "/api/v3/unknown"},
+    };
+    for (const auto& [name, path] : paths) {
+        runner.run("route/" + name, 1, "req", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                {
+                    Request req(arena.resource());
+                    req.method = "GET";
+                    req.path = path;
+                    bench::keep(router.find(req));
+                }
+                arena.release();
             }
+        });
+    }
 
-            handle_client(client_fd);
+    // Response::to_string
+    Response text;
+    text.text("Hello, world!");
+    Response json;
+    {
+        map<string, string> fields;
+        for (int i = 0; i < 32; ++i) fields["key" + std::to_string(i)] = string(20, 'v');
+        json.json(json_object(fields));
+    }
+    Response headers;
+    headers.html(string(4096, 'x'));
+    headers.headers["Cache-Control"] = "public, max-age=3600";
+    headers.headers["ETag"] = "\"5d8c72a5edda8d6a\"";
+    headers.headers["X-Request-Id"] = "b7f3c1de-2f4a-4c8e-9a21-6d0e5f3a7c19";
+    const pair<string, const Response*> responses[] = {
+        {"text", &text}, {"json_1k", &json}, {"html_4k_headers", &headers}};
+    for (const auto& [name, response] : responses) {
+        runner.run("to_string/" + name, 1, "resp", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(response->to_string(true));
+        });
+    }
+
+    runner.finish();
+}
+
+// === 負荷生成 ===
+// `--load [host:]port [path] [-c 接続数] [-d 秒] [--json]` で動いているサーバーに負荷をかける。
+// 接続ごとに 1 スレッドで、keep-alive のまま「送信して応答を読み切る」を繰り返す（閉ループ）。
+// 応答時間はサーバーのメトリクスと同じ LatencyHistogram に集める
+struct LoadOptions {
+    string host = "127.0.0.1";
+    int port = 8080;
+    string path = "/";
+    int connections = 4;
+    double seconds = 5;
+    bool json = false;
+};
+
+LoadOptions parse_load_options(const vector<string>& args) {
+    LoadOptions options;
+    bool have_target = false;
+    for (size_t i = 0; i < args.size(); ++i) {
+        const string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if (arg == "-c" && has_value) {
+            options.connections = max(1, stoi(args[++i]));
+        } else if (arg == "-d" && has_value) {
+            options.seconds = stod(args[++i]);
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (!have_target) {
+            size_t colon = arg.rfind(':');
+            if (colon != string::npos) options.host = arg.substr(0, colon);
+            options.port = stoi(colon != string::npos ? arg.substr(colon + 1) : arg);
+            have_target = true;
+        } else {
+            options.path = arg;
         }
+    }
+    if (options.host == "localhost") options.host = "127.0.0.1";
+    return options;
+}
+
+class LoadClient {
+public:
+    struct Reply {
+        int status = 0;      // 0 なら失敗（切断・不正な応答）
+        size_t bytes = 0;
+        bool close = false;  // サーバーが Connection: close を返した
+    };
+
+    LoadClient(const sockaddr_in& addr, string request) : addr_(addr), request_(move(request)) {}
+    ~LoadClient() { disconnect(); }
 
-        close(server_fd);
+    // 1 リクエスト分を送って応答を読み切る
+    Reply round_trip() {
+        if (fd_ < 0 && !connect_to()) return {};
+        if (!write_all()) {
+            disconnect();
+            return {};
+        }
+        Reply reply = read_reply();
+        if (reply.status == 0 || reply.close) disconnect();
+        return reply;
     }
 
 private:
-    void handle_client(int client_fd) {
-        char buffer[4096] = {0};
-        ssize_t bytes_read = read(client_fd, buffer, sizeof(buffer) - 1);
+    bool connect_to() {
+        fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) return false;
+        if (connect(fd_, reinterpret_cast<const sockaddr*>(&addr_), sizeof(addr_)) < 0) {
+            disconnect();
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+        buf_.clear();
+    }
 
-        if (bytes_read > 0) {
-            try {
-                Request req = Request::parse(buffer);
-                cout << req.method << " " << req.path << endl;
+    bool write_all() {
+        size_t sent = 0;
+        while (sent < request_.size()) {
+            ssize_t n = write(fd_, request_.data() + sent, request_.size() - sent);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
 
-                Response res = router_.route(req);
-                string response_str = res.to_string();
+    bool fill() {
+        char chunk[16384];
+        while (true) {
+            ssize_t n = read(fd_, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buf_.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+    }
 
-                write(client_fd, response_str.c_str(), response_str.size());
-            } catch (const exception& e) {
-                Response res;
-                res.set_status(500).text("Internal Server Error");
-                string response_str = res.to_string();
-                write(client_fd, response_str.c_str(), response_str.size());
+    // ステータス行と Content-Length / Connection だけ見て、ボディは読み捨てる
+    Reply read_reply() {
+        size_t header_end;
+        while ((header_end = buf_.find("\r\n\r\n")) == string::npos) {
+            if (!fill()) return {};
+        }
+
+        Reply reply;
+        string_view head(buf_.data(), header_end);
+        if (head.size() < 12 || head.substr(0, 5) != "HTTP/" ||
+            from_chars(head.data() + 9, head.data() + 12, reply.status).ec != errc()) {
+            return {};
+        }
+
+        size_t content_length = 0;
+        size_t line_start = head.find("\r\n");
+        while (line_start != string_view::npos) {
+            line_start += 2;
+            size_t line_end = head.find("\r\n", line_start);
+            string_view line = head.substr(line_start, line_end - line_start);
+            size_t colon = line.find(':');
+            if (colon != string_view::npos) {
+                string_view name = line.substr(0, colon);
+                string_view value = line.substr(colon + 1);
+                while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+                if (iequals(name, "content-length")) {
+                    from_chars(value.data(), value.data() + value.size(), content_length);
+                } else if (iequals(name, "connection")) {
+                    reply.close = iequals(value, "close");
+                }
             }
+            line_start = line_end;
         }
 
-        close(client_fd);
+        reply.bytes = header_end + 4 + content_length;
+        while (buf_.size() < reply.bytes) {
+            if (!fill()) return {};
+        }
+        buf_.erase(0, reply.bytes);
+        return reply;
     }
 
-    int port_;
-    Router router_;
+    sockaddr_in addr_;
+    string request_;
+    int fd_ = -1;
+    string buf_;
 };
 
-// === JSON ヘルパー（簡易版）===
-string json_object(const map<string, string>& obj) {
-    ostringstream oss;
-    oss << "{";
-    bool first = true;
-    for (const auto& [key, value] : obj) {
-        if (!first) oss << ", ";
-        oss << "\"" << key << "\": \"" << value << "\"";
-        first = false;
+int run_load(const LoadOptions& options) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr) != 1) {
+        cerr << "Invalid IPv4 address: " << options.host << endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    const string request = "GET " + options.path + " HTTP/1.1\r\nHost: " + options.host + ":" +
+                           std::to_string(options.port) + "\r\n\r\n";
+    LatencyHistogram latency;
+    atomic<uint64_t> non_2xx{0}, errors{0}, bytes{0};
+
+    auto start = chrono::steady_clock::now();
+    auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                chrono::duration<double>(options.seconds));
+    vector<thread> threads;
+    for (int c = 0; c < options.connections; ++c) {
+        threads.emplace_back([&] {
+            LoadClient client(addr, request);
+            while (chrono::steady_clock::now() < deadline) {
+                auto sent = chrono::steady_clock::now();
+                LoadClient::Reply reply = client.round_trip();
+                if (reply.status == 0) {
+                    errors.fetch_add(1, memory_order_relaxed);
+                    this_thread::sleep_for(chrono::milliseconds(10));  // 接続できないときに空回りしない
+                    continue;
+                }
+                latency.record(chrono::steady_clock::now() - sent);
+                bytes.fetch_add(reply.bytes, memory_order_relaxed);
+                if (reply.status < 200 || reply.status >= 300) {
+                    non_2xx.fetch_add(1, memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint64_t requests = latency.count();
+    double mean_ns = requests ? static_cast<double>(latency.sum_ns()) / requests : 0;
+    string target = "http://" + options.host + ":" + std::to_string(options.port) + options.path;
+    if (options.json) {
+        string out = "{\"target\":";
+        append_json_string(out, target);
+        cout << out << ",\"connections\":" << options.connections << ",\"seconds\":" << elapsed
+             << ",\"requests\":" << requests << ",\"requests_per_second\":" << requests / elapsed
+             << ",\"bytes_per_second\":" << bytes.load() / elapsed
+             << ",\"latency_ns\":{\"mean\":" << mean_ns << ",\"p50\":" << latency.quantile(0.5)
+             << ",\"p90\":" << latency.quantile(0.9) << ",\"p99\":" << latency.quantile(0.99)
+             << ",\"max\":" << latency.quantile(1.0) << "},\"non_2xx\":" << non_2xx.load()
+             << ",\"errors\":" << errors.load() << "}" << endl;
+    } else {
+        auto us = [](double ns) { return ns / 1000; };
+        cout << fixed << setprecision(1);
+        cout << "target      " << target << " (" << options.connections << " connections, "
+             << elapsed << " s)" << endl;
+        cout << "requests    " << requests << " (" << requests / elapsed << " req/s, "
+             << bytes.load() / elapsed / 1e6 << " MB/s)" << endl;
+        cout << "latency us  mean " << us(mean_ns) << ", p50 " << us(latency.quantile(0.5))
+             << ", p90 " << us(latency.quantile(0.9)) << ", p99 " << us(latency.quantile(0.99))
+             << ", max " << us(latency.quantile(1.0)) << endl;
+        cout << "non-2xx     " << non_2xx.load() << ", errors " << errors.load() << endl;
     }
-    oss << "}";
-    return oss.str();
+    return requests > 0 ? 0 : 1;
 }
 
 // === メイン ===
-int main() {
+// 引数なし（または /source で返すファイルのパス）でサーバーを起動する。--bench はベンチマーク、--load は負荷生成
+int main(int argc, char* argv[]) {
+    vector<string> args(argv + min(argc, 2), argv + argc);
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(args));
+        return 0;
+    }
+    if (argc > 1 && string_view(argv[1]) == "--load") {
+        return run_load(parse_load_options(args));
+    }
+
     cout << "=== HTTP Server Demo ===" << endl << endl;
 
-    HTTPServer server(8080);
+    HTTPServer server(8080, thread::hardware_concurrency());
 
     server.get("/", [](Request& req) {
         Response res;
@@ -322,7 +2292,7 @@ int main() {
 
     server.get("/hello/:name", [](Request& req) {
         Response res;
-        string name = req.path_params["name"];
+        string name(req.path_params["name"]);
         return res.text("Hello, " + name + "!");
     });
 
@@ -348,6 +2318,32 @@ int main() {
         return res.json(json_object(req.query_params));
     });
 
+    server.get("/files/*path", [](Request& req) {
+        Response res;
+        return res.text("File: " + string(req.path_params["path"]));
+    });
+
+    // 待機中もワーカーは他の接続を処理できる
+    server.get("/slow/:key", [](Request& req) -> Task<Response> {
+        string value = co_await slow_lookup(string(req.path_params["key"]));
+        Response res;
+        co_return res.text(value);
+    });
+
+    // このソースファイル自体を sendfile で返す。__FILE__ はコンパイル時の相対パスなので、
+    // 別のディレクトリから起動するときは第 1 引数でパスを渡す。起動時に絶対パスへ解決しておく
+    string source = argc > 1 ? argv[1] : __FILE__;
+    if (char* resolved = realpath(source.c_str(), nullptr)) {
+        source = resolved;
+        free(resolved);
+    } else {
+        cerr << "warning: " << source << " not found, /source will return 404" << endl;
+    }
+    server.get("/source", [source](Request&) {
+        Response res;
+        return res.file(source);
+    });
+
     server.start();
 
     return 0;
@@ -1,15 +1,52 @@
 // JSON Parser - C++ 実装 (再帰下降パーサー)
 
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <variant>
 #include <vector>
 #include <map>
+#include <deque>
 #include <memory>
+#include <string_view>
+#include <span>
+#include <unordered_set>
+#include <memory_resource>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <istream>
+#include <charconv>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <cerrno>
+#include <system_error>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
 #include <stdexcept>
 #include <cctype>
 #include <sstream>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 
@@ -19,22 +56,29 @@ struct JsonValue;
 using JsonNull = nullptr_t;
 using JsonBool = bool;
 using JsonNumber = double;
+using JsonInteger = int64_t;  // 小数部・指数部のない数値は int64 のまま正確に持つ
 using JsonString = string;
 using JsonArray = vector<JsonValue>;
 using JsonObject = map<string, JsonValue>;
 
-struct JsonValue : variant<JsonNull, JsonBool, JsonNumber, JsonString, JsonArray, JsonObject> {
+struct JsonValue : variant<JsonNull, JsonBool, JsonNumber, JsonInteger, JsonString, JsonArray, JsonObject> {
     using variant::variant;
 
     bool is_null() const { return holds_alternative<JsonNull>(*this); }
     bool is_bool() const { return holds_alternative<JsonBool>(*this); }
-    bool is_number() const { return holds_alternative<JsonNumber>(*this); }
+    bool is_number() const { return holds_alternative<JsonNumber>(*this) || is_integer(); }
+    bool is_integer() const { return holds_alternative<JsonInteger>(*this); }
     bool is_string() const { return holds_alternative<JsonString>(*this); }
     bool is_array() const { return holds_alternative<JsonArray>(*this); }
     bool is_object() const { return holds_alternative<JsonObject>(*this); }
 
     const JsonBool& as_bool() const { return get<JsonBool>(*this); }
-    const JsonNumber& as_number() const { return get<JsonNumber>(*this); }
+    // 整数も double に変換して返す
+    JsonNumber as_number() const {
+        if (auto* i = get_if<JsonInteger>(this)) return static_cast<JsonNumber>(*i);
+        return get<JsonNumber>(*this);
+    }
+    JsonInteger as_integer() const { return get<JsonInteger>(*this); }
     const JsonString& as_string() const { return get<JsonString>(*this); }
     const JsonArray& as_array() const { return get<JsonArray>(*this); }
     const JsonObject& as_object() const { return get<JsonObject>(*this); }
@@ -53,10 +97,386 @@ private:
     size_t position_;
 };
 
+// === SIMD スキャナ ===
+// 16/32 バイト単位で「文字列中の特別な文字」と「空白」を探す。
+// x86 は SSE2 を基本に、実行時に AVX2 が使えればそちらを使う。ARM64 は NEON。
+// どれも使えない環境ではスカラー版にフォールバックする。
+namespace scan {
+
+// 文字列中でそのままコピーできない文字: '"' '\\' と制御文字 (< 0x20)
+inline bool is_string_special(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+// JSON の空白は 4 種類だけ（isspace の \v \f は含まない）
+inline bool is_json_whitespace(unsigned char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// p[0..n) の先頭から、特別な文字の直前までの長さ
+size_t string_run_scalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && !is_string_special(p[i])) ++i;
+    return i;
+}
+
+// p[0..n) の先頭から続く空白の長さ
+size_t whitespace_run_scalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && is_json_whitespace(p[i])) ++i;
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+size_t string_run_sse2(const char* p, size_t n) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // 符号なし比較: chunk <= 0x1F  <=>  min(chunk, 0x1F) == chunk
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk));
+        unsigned mask = _mm_movemask_epi8(special);
+        if (mask) return i + countr_zero(mask);
+    }
+    return i + string_run_scalar(p + i, n - i);
+}
+
+size_t whitespace_run_sse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                         _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))));
+        unsigned mask = ~_mm_movemask_epi8(ws) & 0xFFFF;
+        if (mask) return i + countr_zero(mask);
+    }
+    return i + whitespace_run_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t string_run_avx2(const char* p, size_t n) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk));
+        uint32_t mask = _mm256_movemask_epi8(special);
+        if (mask) return i + countr_zero(mask);
+    }
+    return i + string_run_sse2(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t whitespace_run_avx2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i ws = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))));
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+        if (mask) return i + countr_zero(mask);
+    }
+    return i + whitespace_run_sse2(p + i, n - i);
+}
+#elif defined(__aarch64__)
+// NEON には movemask がないので、各バイトを 4 ビットに詰めた 64 ビット値で代用する
+inline uint64_t neon_mask(uint8x16_t m) {
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+}
+
+size_t string_run_neon(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+        uint8x16_t special = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\\'))),
+            vcleq_u8(chunk, vdupq_n_u8(0x1F)));
+        uint64_t mask = neon_mask(special);
+        if (mask) return i + countr_zero(mask) / 4;
+    }
+    return i + string_run_scalar(p + i, n - i);
+}
+
+size_t whitespace_run_neon(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(p + i));
+        uint8x16_t ws = vorrq_u8(
+            vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(' ')), vceqq_u8(chunk, vdupq_n_u8('\n'))),
+            vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('\r')), vceqq_u8(chunk, vdupq_n_u8('\t'))));
+        uint64_t mask = ~neon_mask(ws);
+        if (mask) return i + countr_zero(mask) / 4;
+    }
+    return i + whitespace_run_scalar(p + i, n - i);
+}
+#endif
+
+// 実行時に一度だけ選ぶ
+struct Dispatch {
+    size_t (*string_run)(const char*, size_t);
+    size_t (*whitespace_run)(const char*, size_t);
+    const char* name;
+};
+
+const Dispatch& dispatch() {
+    static const Dispatch selected = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("avx2")) {
+            return Dispatch{string_run_avx2, whitespace_run_avx2, "avx2"};
+        }
+        return Dispatch{string_run_sse2, whitespace_run_sse2, "sse2"};
+#elif defined(__aarch64__)
+        return Dispatch{string_run_neon, whitespace_run_neon, "neon"};
+#else
+        return Dispatch{string_run_scalar, whitespace_run_scalar, "scalar"};
+#endif
+    }();
+    return selected;
+}
+
+inline size_t string_run(const char* p, size_t n) {
+    return dispatch().string_run(p, n);
+}
+
+// トークン間の空白は 0〜1 文字が大半なので、まずスカラーで見てから SIMD に渡す
+inline size_t whitespace_run(const char* p, size_t n) {
+    if (n == 0 || !is_json_whitespace(p[0])) return 0;
+    if (n == 1 || !is_json_whitespace(p[1])) return 1;
+    return 2 + dispatch().whitespace_run(p + 2, n - 2);
+}
+
+}  // namespace scan
+
+// === エスケープ ===
+// 1 文字エスケープ (\n など) を解決する。該当しなければ -1
+inline int simple_escape(char c) {
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'b': return '\b';
+        case 'f': return '\f';
+        case '"': return '"';
+        case '\\': return '\\';
+        case '/': return '/';
+        default: return -1;
+    }
+}
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// === 数値 ===
+// 入力から直接読み、一時文字列を作らない。
+// 整数は int64 に収まる限り正確に、それ以外は
+// 仮数 ≤ 2^53 かつ |10 の指数| ≤ 22 なら 1 回の乗除算で正確に求め (Clinger の高速パス)、
+// 残りは from_chars（libstdc++ では Eisel-Lemire 実装）に任せる。
+struct JsonNumberToken {
+    bool integer = false;
+    int64_t i = 0;
+    double d = 0;
+    size_t length = 0;            // 読んだ文字数
+    const char* error = nullptr;  // 文法エラーならメッセージ
+    size_t error_at = 0;          // エラー位置 (先頭からのオフセット)
+};
+
+inline bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline double parse_double_slow(const char* first, const char* last) {
+    double d = 0;
+#if defined(__cpp_lib_to_chars)
+    // from_chars はロケールに依存しない
+    auto [ptr, ec] = from_chars(first, last, d);
+    if (ec == errc::result_out_of_range) {
+        // 桁あふれなら ±inf、下位あふれなら ±0。最上位の非ゼロ桁の位で見分ける（文法は検査済み）
+        bool negative = *first == '-';
+        const char* p = first + negative;
+        int64_t int_digits = 0;  // 先頭の 0 を除いた整数部の桁数
+        int64_t frac_zeros = 0;  // 整数部が 0 のとき、小数点の後の最初の非ゼロ桁までの 0 の数
+        for (; p != last && is_digit(*p); ++p) {
+            if (int_digits > 0 || *p != '0') ++int_digits;
+        }
+        if (p != last && *p == '.') {
+            bool seen = int_digits > 0;
+            for (++p; p != last && is_digit(*p); ++p) {
+                if (!seen && *p == '0') {
+                    ++frac_zeros;
+                } else {
+                    seen = true;
+                }
+            }
+        }
+        int64_t exponent = 0;
+        if (p != last && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negative_exponent = p != last && *p == '-';
+            if (p != last && (*p == '-' || *p == '+')) ++p;
+            for (; p != last && is_digit(*p); ++p) {
+                exponent = min<int64_t>(exponent * 10 + (*p - '0'), 1'000'000'000);
+            }
+            if (negative_exponent) exponent = -exponent;
+        }
+        int64_t leading = int_digits > 0 ? int_digits - 1 : -(frac_zeros + 1);
+        double magnitude = leading + exponent > 0 ? numeric_limits<double>::infinity() : 0.0;
+        return negative ? -magnitude : magnitude;
+    }
+#else
+    d = strtod(string(first, last).c_str(), nullptr);
+#endif
+    return d;
+}
+
+JsonNumberToken read_json_number(string_view s) {
+    static constexpr double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    JsonNumberToken t;
+    const char* p = s.data();
+    const char* end = p + s.size();
+    auto fail = [&](const char* msg) {
+        t.error = msg;
+        t.error_at = static_cast<size_t>(p - s.data());
+        return t;
+    };
+
+    bool negative = p < end && *p == '-';
+    if (negative) ++p;
+
+    // 仮数は最初の 19 桁まで uint64 に溜める
+    uint64_t mantissa = 0;
+    int digits = 0;        // 仮数に入れた有効桁数
+    bool truncated = false;
+    int exp10 = 0;
+
+    auto take_digit = [&](char c) {
+        if (digits < 19) {
+            if (mantissa != 0 || c != '0') {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+                if (mantissa != 0) ++digits;
+            }
+            return true;
+        }
+        if (c != '0') truncated = true;
+        return false;  // 桁を落とした
+    };
+
+    // 整数部
+    if (p < end && *p == '0') {
+        ++p;
+    } else if (p < end && is_digit(*p)) {
+        while (p < end && is_digit(*p)) {
+            if (!take_digit(*p)) ++exp10;
+            ++p;
+        }
+    } else {
+        return fail("Expected digit");
+    }
+
+    bool has_fraction = false;
+    bool has_exponent = false;
+
+    // 小数部
+    if (p < end && *p == '.') {
+        has_fraction = true;
+        ++p;
+        if (p == end || !is_digit(*p)) return fail("Expected digit after decimal point");
+        while (p < end && is_digit(*p)) {
+            if (take_digit(*p)) --exp10;
+            ++p;
+        }
+    }
+
+    // 指数部
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        has_exponent = true;
+        ++p;
+        bool exp_negative = false;
+        if (p < end && (*p == '+' || *p == '-')) exp_negative = *p++ == '-';
+        if (p == end || !is_digit(*p)) return fail("Expected digit in exponent");
+        int e = 0;
+        while (p < end && is_digit(*p)) {
+            if (e < 100000) e = e * 10 + (*p - '0');
+            ++p;
+        }
+        exp10 += exp_negative ? -e : e;
+    }
+
+    t.length = static_cast<size_t>(p - s.data());
+
+    // 整数: -0 は double の -0.0 として残す
+    if (!has_fraction && !has_exponent && !truncated && exp10 == 0 && !(negative && mantissa == 0)) {
+        if (!negative && mantissa <= static_cast<uint64_t>(numeric_limits<int64_t>::max())) {
+            t.integer = true;
+            t.i = static_cast<int64_t>(mantissa);
+            return t;
+        }
+        if (negative && mantissa <= static_cast<uint64_t>(numeric_limits<int64_t>::max()) + 1) {
+            t.integer = true;
+            t.i = static_cast<int64_t>(0 - mantissa);
+            return t;
+        }
+    }
+
+    if (!truncated && mantissa <= (uint64_t{1} << 53) && exp10 >= -22 && exp10 <= 22) {
+        double d = static_cast<double>(mantissa);
+        d = exp10 < 0 ? d / pow10[-exp10] : d * pow10[exp10];
+        t.d = negative ? -d : d;
+        return t;
+    }
+
+    t.d = parse_double_slow(s.data(), p);
+    return t;
+}
+
+// 最短で往復可能な表現を書く。JSON に NaN / Infinity はないので null にする
+inline void append_json_number(string& out, double d) {
+    if (!isfinite(d)) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+#if defined(__cpp_lib_to_chars)
+    auto [ptr, ec] = to_chars(buf, buf + sizeof(buf), d);
+    out.append(buf, ptr);
+#else
+    int n = snprintf(buf, sizeof(buf), "%.17g", d);
+    out.append(buf, static_cast<size_t>(n));
+#endif
+}
+
+inline void append_json_number(string& out, int64_t i) {
+    char buf[24];
+    auto [ptr, ec] = to_chars(buf, buf + sizeof(buf), i);
+    out.append(buf, ptr);
+}
+
 // === Tokenizer ===
 class Tokenizer {
 public:
-    Tokenizer(const string& input) : input_(input), position_(0) {}
+    // 入力はコピーしない。呼び出し側がパース中の寿命を保証する
+    explicit Tokenizer(string_view input) : input_(input), position_(0) {}
 
     size_t position() const { return position_; }
 
@@ -74,15 +494,30 @@ public:
     }
 
     void skip_whitespace() {
-        while (isspace(current())) {
-            advance();
-        }
+        position_ += scan::whitespace_run(input_.data() + position_, input_.size() - position_);
+    }
+
+    // 現在位置から、文字列中でそのままコピーできる部分を返して読み進める
+    string_view take_string_run() {
+        size_t n = scan::string_run(input_.data() + position_, input_.size() - position_);
+        string_view run(input_.data() + position_, n);
+        position_ += n;
+        return run;
     }
 
     bool eof() const {
         return position_ >= input_.size();
     }
 
+    // 現在位置から末尾まで
+    string_view rest() const {
+        return input_.substr(position_);
+    }
+
+    void skip(size_t n) {
+        position_ += n;
+    }
+
     void expect(char c) {
         if (current() != c) {
             throw ParseError(
@@ -94,18 +529,24 @@ public:
     }
 
 private:
-    string input_;
+    string_view input_;
     size_t position_;
 };
 
 // === Parser ===
-class JsonParser {
+// 文法は BasicJsonParser が持ち、値の組み立ては Builder に任せる。
+// Builder は Value / Key / Array / Object 型と make_* / begin_* / push / add を提供する。
+template<typename Builder>
+class BasicJsonParser {
 public:
-    JsonParser(const string& input) : tokenizer_(input) {}
+    using Value = typename Builder::Value;
+
+    BasicJsonParser(string_view input, Builder builder = {})
+        : tokenizer_(input), builder_(move(builder)) {}
 
-    JsonValue parse() {
+    Value parse() {
         tokenizer_.skip_whitespace();
-        JsonValue value = parse_value();
+        Value value = parse_value();
         tokenizer_.skip_whitespace();
 
         if (!tokenizer_.eof()) {
@@ -119,18 +560,27 @@ public:
     }
 
 private:
-    JsonValue parse_value() {
+    // エスケープを含まない文字列は入力へのビュー、含む場合は scratch_ へのビュー。
+    // scratch_ は次の文字列で上書きされるので、受け取った側がすぐ Builder に渡す。
+    struct RawString {
+        string_view text;
+        bool decoded;
+    };
+
+    Value parse_value() {
         tokenizer_.skip_whitespace();
         char c = tokenizer_.current();
 
         if (c == '\0') {
             throw ParseError("Unexpected end of input", tokenizer_.position());
         } else if (c == 'n') {
-            return parse_null();
+            parse_null();
+            return builder_.make_null();
         } else if (c == 't' || c == 'f') {
-            return parse_bool();
+            return builder_.make_bool(parse_bool());
         } else if (c == '"') {
-            return parse_string();
+            RawString raw = parse_string();
+            return builder_.make_string(raw.text, raw.decoded);
         } else if (c == '[') {
             return parse_array();
         } else if (c == '{') {
@@ -145,9 +595,8 @@ private:
         }
     }
 
-    JsonNull parse_null() {
+    void parse_null() {
         expect_keyword("null");
-        return nullptr;
     }
 
     JsonBool parse_bool() {
@@ -160,7 +609,7 @@ private:
         }
     }
 
-    void expect_keyword(const string& keyword) {
+    void expect_keyword(string_view keyword) {
         for (char expected : keyword) {
             char actual = tokenizer_.advance();
             if (actual != expected) {
@@ -172,115 +621,87 @@ private:
         }
     }
 
-    JsonString parse_string() {
+    RawString parse_string() {
         tokenizer_.advance();  // consume opening "
-        string result;
+
+        // よくある「エスケープなし」の文字列はコピーせずに返す
+        string_view run = tokenizer_.take_string_run();
+        if (!tokenizer_.eof() && tokenizer_.current() == '"') {
+            tokenizer_.advance();
+            return {run, false};
+        }
+
+        string& result = scratch_;
+        result.assign(run);
 
         while (true) {
-            char c = tokenizer_.advance();
+            // エスケープのない部分はまとめてコピー
+            result += tokenizer_.take_string_run();
 
-            if (c == '\0') {
+            if (tokenizer_.eof()) {
                 throw ParseError("Unterminated string", tokenizer_.position());
-            } else if (c == '"') {
+            }
+
+            char c = tokenizer_.advance();
+            if (c == '"') {
                 break;
             } else if (c == '\\') {
                 result += parse_escape_sequence();
             } else {
-                result += c;
+                throw ParseError("Control character in string", tokenizer_.position() - 1);
             }
         }
 
-        return result;
+        return {result, true};
     }
 
     char parse_escape_sequence() {
         char c = tokenizer_.advance();
 
-        switch (c) {
-            case 'n': return '\n';
-            case 't': return '\t';
-            case 'r': return '\r';
-            case '"': return '"';
-            case '\\': return '\\';
-            case '/': return '/';
-            case 'u': {
-                // Unicode escape
-                string hex;
-                for (int i = 0; i < 4; ++i) {
-                    hex += tokenizer_.advance();
+        if (int simple = simple_escape(c); simple >= 0) {
+            return static_cast<char>(simple);
+        }
+        if (c == 'u') {
+            // Unicode escape
+            int codepoint = 0;
+            for (int i = 0; i < 4; ++i) {
+                int digit = hex_value(tokenizer_.advance());
+                if (digit < 0) {
+                    throw ParseError("Invalid unicode escape", tokenizer_.position() - 1);
                 }
-                int codepoint = stoi(hex, nullptr, 16);
-                // 簡易実装: ASCII 範囲のみ対応
-                return static_cast<char>(codepoint);
+                codepoint = codepoint * 16 + digit;
             }
-            default:
-                throw ParseError(
-                    string("Invalid escape sequence: \\") + c,
-                    tokenizer_.position()
-                );
+            // 簡易実装: ASCII 範囲のみ対応
+            return static_cast<char>(codepoint);
         }
+        throw ParseError(
+            string("Invalid escape sequence: \\") + c,
+            tokenizer_.position()
+        );
     }
 
-    JsonNumber parse_number() {
-        string num_str;
-
-        // 負号
-        if (tokenizer_.current() == '-') {
-            num_str += tokenizer_.advance();
-        }
-
-        // 整数部
-        if (tokenizer_.current() == '0') {
-            num_str += tokenizer_.advance();
-        } else if (isdigit(tokenizer_.current())) {
-            while (isdigit(tokenizer_.current())) {
-                num_str += tokenizer_.advance();
-            }
-        } else {
-            throw ParseError("Expected digit", tokenizer_.position());
-        }
-
-        // 小数部
-        if (tokenizer_.current() == '.') {
-            num_str += tokenizer_.advance();
-            if (!isdigit(tokenizer_.current())) {
-                throw ParseError("Expected digit after decimal point", tokenizer_.position());
-            }
-            while (isdigit(tokenizer_.current())) {
-                num_str += tokenizer_.advance();
-            }
-        }
-
-        // 指数部
-        if (tokenizer_.current() == 'e' || tokenizer_.current() == 'E') {
-            num_str += tokenizer_.advance();
-            if (tokenizer_.current() == '+' || tokenizer_.current() == '-') {
-                num_str += tokenizer_.advance();
-            }
-            if (!isdigit(tokenizer_.current())) {
-                throw ParseError("Expected digit in exponent", tokenizer_.position());
-            }
-            while (isdigit(tokenizer_.current())) {
-                num_str += tokenizer_.advance();
-            }
+    Value parse_number() {
+        JsonNumberToken t = read_json_number(tokenizer_.rest());
+        if (t.error) {
+            throw ParseError(t.error, tokenizer_.position() + t.error_at);
         }
-
-        return stod(num_str);
+        tokenizer_.skip(t.length);
+        return t.integer ? builder_.make_integer(t.i) : builder_.make_number(t.d);
     }
 
-    JsonArray parse_array() {
+    Value parse_array() {
         tokenizer_.advance();  // consume [
         tokenizer_.skip_whitespace();
 
-        JsonArray arr;
+        typename Builder::Array arr = builder_.begin_array();
 
         if (tokenizer_.current() == ']') {
             tokenizer_.advance();
-            return arr;
+            return builder_.make_array(move(arr));
         }
 
         while (true) {
-            arr.push_back(parse_value());
+            builder_.push(arr, parse_value());
             tokenizer_.skip_whitespace();
 
             char c = tokenizer_.current();
@@ -295,18 +716,18 @@ private:
             }
         }
 
-        return arr;
+        return builder_.make_array(move(arr));
     }
 
-    JsonObject parse_object() {
+    Value parse_object() {
         tokenizer_.advance();  // consume {
         tokenizer_.skip_whitespace();
 
-        JsonObject obj;
+        typename Builder::Object obj = builder_.begin_object();
 
         if (tokenizer_.current() == '}') {
             tokenizer_.advance();
-            return obj;
+            return builder_.make_object(move(obj));
         }
 
         while (true) {
@@ -315,13 +736,15 @@ private:
             if (tokenizer_.current() != '"') {
                 throw ParseError("Expected string key", tokenizer_.position());
             }
-            string key = parse_string();
+            // 値のパースで scratch_ が上書きされる前にキーを確定させる
+            RawString raw_key = parse_string();
+            typename Builder::Key key = builder_.make_key(raw_key.text, raw_key.decoded);
 
             tokenizer_.skip_whitespace();
             tokenizer_.expect(':');
 
-            JsonValue value = parse_value();
-            obj[key] = value;
+            Value value = parse_value();
+            builder_.add(obj, move(key), move(value));
 
             tokenizer_.skip_whitespace();
 
@@ -336,157 +759,1861 @@ private:
             }
         }
 
-        return obj;
+        return builder_.make_object(move(obj));
     }
 
     Tokenizer tokenizer_;
+    Builder builder_;
+    string scratch_;
 };
 
-// === 便利関数 ===
-JsonValue parse_json(const string& input) {
-    return JsonParser(input).parse();
-}
+// JsonValue (所有型 DOM) を組み立てる Builder
+struct JsonValueBuilder {
+    using Value = JsonValue;
+    using Key = string;
+    using Array = JsonArray;
+    using Object = JsonObject;
+
+    Value make_null() { return nullptr; }
+    Value make_bool(bool b) { return b; }
+    Value make_number(double d) { return d; }
+    Value make_integer(int64_t i) { return i; }
+    Value make_string(string_view s, bool) { return JsonString(s); }
+    Key make_key(string_view s, bool) { return Key(s); }
+    Array begin_array() { return {}; }
+    Object begin_object() { return {}; }
+    Value make_array(Array&& arr) { return move(arr); }
+    Value make_object(Object&& obj) { return move(obj); }
+
+    void push(Array& arr, Value&& value) { arr.push_back(move(value)); }
+    void add(Object& obj, Key&& key, Value&& value) { obj.insert_or_assign(move(key), move(value)); }
+};
 
-// === JSON 文字列化 ===
-string stringify(const JsonValue& value, int indent = 0);
-
-string stringify_impl(const JsonValue& value, int indent, int current_indent) {
-    string pad(current_indent, ' ');
-    string inner_pad(current_indent + indent, ' ');
-
-    if (value.is_null()) {
-        return "null";
-    } else if (value.is_bool()) {
-        return value.as_bool() ? "true" : "false";
-    } else if (value.is_number()) {
-        ostringstream oss;
-        oss << value.as_number();
-        return oss.str();
-    } else if (value.is_string()) {
-        return "\"" + value.as_string() + "\"";
-    } else if (value.is_array()) {
-        const auto& arr = value.as_array();
-        if (arr.empty()) return "[]";
-
-        ostringstream oss;
-        oss << "[";
-        if (indent > 0) oss << "\n";
-        for (size_t i = 0; i < arr.size(); ++i) {
-            if (indent > 0) oss << inner_pad;
-            oss << stringify_impl(arr[i], indent, current_indent + indent);
-            if (i < arr.size() - 1) oss << ",";
-            if (indent > 0) oss << "\n";
-        }
-        if (indent > 0) oss << pad;
-        oss << "]";
-        return oss.str();
-    } else if (value.is_object()) {
-        const auto& obj = value.as_object();
-        if (obj.empty()) return "{}";
-
-        ostringstream oss;
-        oss << "{";
-        if (indent > 0) oss << "\n";
-        size_t i = 0;
-        for (const auto& [key, val] : obj) {
-            if (indent > 0) oss << inner_pad;
-            oss << "\"" << key << "\": ";
-            oss << stringify_impl(val, indent, current_indent + indent);
-            if (i < obj.size() - 1) oss << ",";
-            if (indent > 0) oss << "\n";
-            ++i;
+using JsonParser = BasicJsonParser<JsonValueBuilder>;
+
+// === ビューモード (ゼロコピー) ===
+// エスケープのない文字列とキーは入力バッファへの string_view のまま持つ。
+// エスケープを含むものだけデコードして JsonViewDocument が所有する。
+struct JsonViewValue;
+
+using JsonViewArray = vector<JsonViewValue>;
+using JsonViewObject = vector<pair<string_view, JsonViewValue>>;  // 出現順
+
+struct JsonViewValue : variant<JsonNull, JsonBool, JsonNumber, JsonInteger, string_view, JsonViewArray, JsonViewObject> {
+    using variant::variant;
+
+    bool is_null() const { return holds_alternative<JsonNull>(*this); }
+    bool is_bool() const { return holds_alternative<JsonBool>(*this); }
+    bool is_number() const { return holds_alternative<JsonNumber>(*this) || is_integer(); }
+    bool is_integer() const { return holds_alternative<JsonInteger>(*this); }
+    bool is_string() const { return holds_alternative<string_view>(*this); }
+    bool is_array() const { return holds_alternative<JsonViewArray>(*this); }
+    bool is_object() const { return holds_alternative<JsonViewObject>(*this); }
+
+    JsonBool as_bool() const { return get<JsonBool>(*this); }
+    JsonNumber as_number() const {
+        if (auto* i = get_if<JsonInteger>(this)) return static_cast<JsonNumber>(*i);
+        return get<JsonNumber>(*this);
+    }
+    JsonInteger as_integer() const { return get<JsonInteger>(*this); }
+    string_view as_string() const { return get<string_view>(*this); }
+    const JsonViewArray& as_array() const { return get<JsonViewArray>(*this); }
+    const JsonViewObject& as_object() const { return get<JsonViewObject>(*this); }
+
+    // 重複キーは JsonObject と同じく後勝ち
+    const JsonViewValue* find(string_view key) const {
+        const auto& obj = as_object();
+        for (auto it = obj.rbegin(); it != obj.rend(); ++it) {
+            if (it->first == key) return &it->second;
         }
-        if (indent > 0) oss << pad;
-        oss << "}";
-        return oss.str();
+        return nullptr;
     }
+};
 
-    return "";
-}
+// 読み取り専用の mmap。ファイルをメモリに読み込まずにパースする
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw runtime_error("Cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            ::close(fd);
+            throw runtime_error("Cannot stat " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw runtime_error("Cannot mmap " + path);
+            }
+            data_ = static_cast<const char*>(p);
+        }
+        ::close(fd);
+    }
 
-string stringify(const JsonValue& value, int indent) {
-    return stringify_impl(value, indent, 0);
-}
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
+    }
 
-// === デモ ===
-void demo() {
-    vector<string> examples = {
-        "null",
-        "true",
-        "42",
-        "3.14",
-        "\"hello\"",
-        "[1, 2, 3]",
-        "{\"name\": \"C++\", \"version\": 20}",
-        "{\"nested\": {\"array\": [1, true, null]}}"
-    };
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
 
-    for (const auto& json : examples) {
-        cout << "Input:  " << json << endl;
-        try {
-            JsonValue result = parse_json(json);
-            cout << "Parsed: " << stringify(result) << endl;
-        } catch (const ParseError& e) {
-            cout << "Error:  " << e.what() << endl;
-        }
-        cout << endl;
+    string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// ビューモードの結果。デコード済み文字列と (あれば) mmap を保持する。
+// deque なのでムーブしても要素のアドレスは変わらず、ビューは有効なまま
+class JsonViewDocument {
+public:
+    const JsonViewValue& root() const { return root_; }
+    string_view source() const { return source_; }
+    size_t decoded_count() const { return decoded_.size(); }
+
+private:
+    friend struct JsonViewBuilder;
+    friend JsonViewDocument parse_json_view(string_view input);
+    friend JsonViewDocument parse_json_file(const string& path);
+
+    string_view source_;
+    unique_ptr<MappedFile> mapping_;
+    deque<string> decoded_;
+    JsonViewValue root_;
+};
+
+struct JsonViewBuilder {
+    using Value = JsonViewValue;
+    using Key = string_view;
+    using Array = JsonViewArray;
+    using Object = JsonViewObject;
+
+    JsonViewDocument* doc;
+
+    string_view keep(string_view s, bool decoded) {
+        if (!decoded) return s;
+        return doc->decoded_.emplace_back(s);
     }
-}
 
-// === テスト ===
-void run_tests() {
-    cout << "--- Tests ---" << endl;
+    Value make_null() { return nullptr; }
+    Value make_bool(bool b) { return b; }
+    Value make_number(double d) { return d; }
+    Value make_integer(int64_t i) { return i; }
+    Value make_string(string_view s, bool decoded) { return keep(s, decoded); }
+    Key make_key(string_view s, bool decoded) { return keep(s, decoded); }
+    Array begin_array() { return {}; }
+    Object begin_object() { return {}; }
+    Value make_array(Array&& arr) { return move(arr); }
+    Value make_object(Object&& obj) { return move(obj); }
+
+    void push(Array& arr, Value&& value) { arr.push_back(move(value)); }
+    void add(Object& obj, Key key, Value&& value) { obj.emplace_back(key, move(value)); }
+};
 
-    // null
-    assert(parse_json("null").is_null());
+// === アリーナ DOM ===
+// ドキュメント 1 つにつき 1 つの monotonic_buffer_resource から全ノードを確保する。
+// ノードは 16 バイトの POD で、配列・オブジェクトは子を連続領域に並べる。
+// オブジェクトは出現順のキー配列で、大きいものだけハッシュ索引を持つ。
+// キーはドキュメント内でインターンされ、解放はアリーナごと一度で済む。
+struct JsonMember;
+struct JsonObjectBody;
 
-    // bool
-    assert(parse_json("true").as_bool() == true);
-    assert(parse_json("false").as_bool() == false);
+class JsonNode {
+public:
+    enum class Type : uint8_t { Null, Bool, Number, Integer, String, Array, Object };
+
+    JsonNode() : number_(0) {}
+
+    Type type() const { return type_; }
+    bool is_null() const { return type_ == Type::Null; }
+    bool is_bool() const { return type_ == Type::Bool; }
+    bool is_number() const { return type_ == Type::Number || type_ == Type::Integer; }
+    bool is_integer() const { return type_ == Type::Integer; }
+    bool is_string() const { return type_ == Type::String; }
+    bool is_array() const { return type_ == Type::Array; }
+    bool is_object() const { return type_ == Type::Object; }
+
+    bool as_bool() const { check(Type::Bool); return bool_; }
+    double as_number() const {
+        if (type_ == Type::Integer) return static_cast<double>(integer_);
+        check(Type::Number);
+        return number_;
+    }
+    int64_t as_integer() const { check(Type::Integer); return integer_; }
+    string_view as_string() const { check(Type::String); return {str_, size_}; }
 
-    // number
-    assert(parse_json("42").as_number() == 42);
-    assert(parse_json("-17").as_number() == -17);
-    assert(parse_json("3.14").as_number() == 3.14);
-    assert(parse_json("1e10").as_number() == 1e10);
+    // 配列・オブジェクトの要素数
+    size_t size() const { return is_array() || is_object() ? size_ : 0; }
 
-    // string
-    assert(parse_json("\"hello\"").as_string() == "hello");
-    assert(parse_json("\"hello\\nworld\"").as_string() == "hello\nworld");
+    span<const JsonNode> items() const {
+        check(Type::Array);
+        return {items_, size_};
+    }
 
-    // array
-    assert(parse_json("[]").as_array().empty());
-    assert(parse_json("[1, 2, 3]").as_array().size() == 3);
+    const JsonNode& operator[](size_t i) const { return items()[i]; }
 
-    // object
-    assert(parse_json("{}").as_object().empty());
-    auto obj = parse_json("{\"name\": \"C++\"}").as_object();
-    assert(obj["name"].as_string() == "C++");
+    span<const JsonMember> members() const;
+    const JsonNode* find(string_view key) const;
 
-    // nested
-    auto nested = parse_json("{\"arr\": [1, {\"nested\": true}]}");
-    assert(nested.as_object().at("arr").as_array()[1].as_object().at("nested").as_bool() == true);
+    // 通常の JsonValue に変換する（比較・文字列化用）
+    JsonValue to_value() const;
 
-    // whitespace
-    auto ws = parse_json("  { \"key\" : \"value\" }  ");
-    assert(ws.as_object().at("key").as_string() == "value");
+private:
+    friend struct JsonArenaBuilder;
 
-    // errors
-    try {
-        parse_json("");
-        assert(false && "empty input should fail");
-    } catch (const ParseError&) {}
+    void check(Type t) const {
+        if (type_ != t) throw bad_variant_access();
+    }
 
-    try {
-        parse_json("{");
-        assert(false && "unclosed object should fail");
-    } catch (const ParseError&) {}
+    Type type_ = Type::Null;
+    bool bool_ = false;
+    uint32_t size_ = 0;
+    union {
+        double number_;
+        int64_t integer_;
+        const char* str_;
+        const JsonNode* items_;
+        const JsonObjectBody* object_;
+    };
+};
 
-    cout << "All tests passed!" << endl;
+struct JsonMember {
+    string_view key;
+    JsonNode value;
+};
+
+struct JsonObjectBody {
+    const JsonMember* members;
+    const uint32_t* index;   // nullptr なら線形探索
+    uint32_t index_mask;     // 索引のスロット数 - 1
+};
+
+// この要素数以上のオブジェクトにハッシュ索引を付ける
+constexpr size_t json_index_threshold = 16;
+
+inline span<const JsonMember> JsonNode::members() const {
+    check(Type::Object);
+    return {object_->members, size_};
+}
+
+inline const JsonNode* JsonNode::find(string_view key) const {
+    check(Type::Object);
+    const JsonObjectBody& body = *object_;
+    if (body.index) {
+        size_t slot = hash<string_view>{}(key) & body.index_mask;
+        // 空きスロットは UINT32_MAX。オープンアドレス法（線形探査）
+        for (uint32_t i; (i = body.index[slot]) != UINT32_MAX; slot = (slot + 1) & body.index_mask) {
+            if (body.members[i].key == key) return &body.members[i].value;
+        }
+        return nullptr;
+    }
+    // 重複キーは後勝ち
+    for (size_t i = size_; i-- > 0;) {
+        if (body.members[i].key == key) return &body.members[i].value;
+    }
+    return nullptr;
+}
+
+JsonValue JsonNode::to_value() const {
+    switch (type_) {
+        case Type::Null: return nullptr;
+        case Type::Bool: return bool_;
+        case Type::Number: return number_;
+        case Type::Integer: return integer_;
+        case Type::String: return JsonString(as_string());
+        case Type::Array: {
+            JsonArray arr;
+            arr.reserve(size_);
+            for (const JsonNode& item : items()) arr.push_back(item.to_value());
+            return arr;
+        }
+        case Type::Object: {
+            JsonObject obj;
+            for (const JsonMember& m : members()) obj.insert_or_assign(string(m.key), m.value.to_value());
+            return obj;
+        }
+    }
+    return nullptr;
 }
 
-int main() {
+class JsonArenaDocument {
+public:
+    const JsonNode& root() const { return root_; }
+    // アリーナから確保したバイト数（ノード・文字列・索引の合計）
+    size_t allocated_bytes() const { return allocated_; }
+
+private:
+    friend struct JsonArenaBuilder;
+    friend JsonArenaDocument parse_json_arena(string_view input, pmr::memory_resource* upstream);
+
+    unique_ptr<pmr::monotonic_buffer_resource> arena_;
+    JsonNode root_;
+    size_t allocated_ = 0;
+};
+
+struct JsonArenaBuilder {
+    using Value = JsonNode;
+    using Key = string_view;
+    // 子はパース中は共有スタックに積み、閉じた時点でアリーナへ連続コピーする
+    struct Array { size_t start; };
+    struct Object { size_t start; };
+
+    JsonArenaDocument* doc;
+    vector<JsonNode> item_stack;
+    vector<JsonMember> member_stack;
+    unordered_set<string_view> keys;
+
+    template<typename T>
+    T* allocate(size_t n) {
+        doc->allocated_ += n * sizeof(T);
+        return static_cast<T*>(doc->arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    string_view copy(string_view s) {
+        char* p = allocate<char>(s.size());
+        memcpy(p, s.data(), s.size());
+        return {p, s.size()};
+    }
+
+    static Value node(JsonNode::Type type) {
+        JsonNode n;
+        n.type_ = type;
+        return n;
+    }
+
+    Value make_null() { return node(JsonNode::Type::Null); }
+
+    Value make_bool(bool b) {
+        JsonNode n = node(JsonNode::Type::Bool);
+        n.bool_ = b;
+        return n;
+    }
+
+    Value make_number(double d) {
+        JsonNode n = node(JsonNode::Type::Number);
+        n.number_ = d;
+        return n;
+    }
+
+    Value make_integer(int64_t i) {
+        JsonNode n = node(JsonNode::Type::Integer);
+        n.integer_ = i;
+        return n;
+    }
+
+    Value make_string(string_view s, bool) {
+        string_view stored = copy(s);
+        JsonNode n = node(JsonNode::Type::String);
+        n.str_ = stored.data();
+        n.size_ = static_cast<uint32_t>(stored.size());
+        return n;
+    }
+
+    Key make_key(string_view s, bool) {
+        auto it = keys.find(s);
+        if (it != keys.end()) return *it;
+        return *keys.insert(copy(s)).first;
+    }
+
+    Array begin_array() { return {item_stack.size()}; }
+    Object begin_object() { return {member_stack.size()}; }
+
+    void push(Array&, Value&& value) { item_stack.push_back(value); }
+    void add(Object&, Key key, Value&& value) { member_stack.push_back({key, value}); }
+
+    Value make_array(Array&& arr) {
+        size_t n = item_stack.size() - arr.start;
+        JsonNode* items = allocate<JsonNode>(n);
+        copy_n(item_stack.begin() + arr.start, n, items);
+        item_stack.resize(arr.start);
+
+        JsonNode result = node(JsonNode::Type::Array);
+        result.items_ = items;
+        result.size_ = static_cast<uint32_t>(n);
+        return result;
+    }
+
+    Value make_object(Object&& obj) {
+        size_t n = member_stack.size() - obj.start;
+        JsonMember* members = allocate<JsonMember>(n);
+        copy_n(member_stack.begin() + obj.start, n, members);
+        member_stack.resize(obj.start);
+
+        JsonObjectBody* body = allocate<JsonObjectBody>(1);
+        *body = {members, nullptr, 0};
+        if (n >= json_index_threshold) {
+            size_t slots = bit_ceil(n * 2);
+            uint32_t* index = allocate<uint32_t>(slots);
+            fill_n(index, slots, UINT32_MAX);
+            size_t mask = slots - 1;
+            for (uint32_t i = 0; i < n; ++i) {
+                size_t slot = hash<string_view>{}(members[i].key) & mask;
+                while (index[slot] != UINT32_MAX && members[index[slot]].key != members[i].key) {
+                    slot = (slot + 1) & mask;
+                }
+                index[slot] = i;  // 重複キーは後勝ちで上書き
+            }
+            body->index = index;
+            body->index_mask = static_cast<uint32_t>(mask);
+        }
+
+        JsonNode result = node(JsonNode::Type::Object);
+        result.object_ = body;
+        result.size_ = static_cast<uint32_t>(n);
+        return result;
+    }
+};
+
+// 文字列は全てアリーナにコピーするので、input はパース後に破棄してよい。
+// アリーナのブロックは upstream から取る（確保回数を数えたり、プールから取ったりできる）
+JsonArenaDocument parse_json_arena(string_view input,
+                                   pmr::memory_resource* upstream = pmr::get_default_resource()) {
+    JsonArenaDocument doc;
+    // 最初のブロックを入力サイズ程度にしておくと、小さな文書は 1 回の確保で済む
+    doc.arena_ = make_unique<pmr::monotonic_buffer_resource>(max<size_t>(input.size(), 1024), upstream);
+    doc.root_ = BasicJsonParser<JsonArenaBuilder>(input, JsonArenaBuilder{&doc, {}, {}, {}}).parse();
+    return doc;
+}
+
+// === ストリーミング (SAX) パーサー ===
+// 入力を任意の位置で区切ったチャンクで受け取り、状態を保持したまま次のチャンクで再開する。
+// 文法は BasicJsonParser と同じで、ツリーを作らずに Handler へイベントを通知する。
+// 保持するのは入れ子のスタックと途中のトークン 1 つだけなので、入力全体の大きさに依存しない。
+//
+// Handler: null_value() bool_value(b) number_value(d) integer_value(i) string_value(sv) key(sv)
+//          start_object() end_object() start_array() end_array() end_document()
+// string_value / key の string_view はコールバック中だけ有効。
+// ndjson = true なら改行区切りの複数ドキュメントを受け付け、1 件ごとに end_document() を呼ぶ。
+template<typename Handler>
+class JsonStreamParser {
+public:
+    explicit JsonStreamParser(Handler& handler, bool ndjson = false)
+        : handler_(handler), ndjson_(ndjson),
+          state_(ndjson ? State::DocEnd : State::Value), saw_newline_(true) {}
+
+    void feed(string_view chunk) {
+        chunk_ = chunk;
+        size_t i = 0;
+        while (i < chunk.size()) {
+            switch (state_) {
+                case State::String: i = continue_string(i); break;
+                case State::Number: i = continue_number(i); break;
+                case State::Literal: i = continue_literal(i); break;
+                case State::DocEnd: i = between_documents(i); break;
+                default:
+                    i += scan::whitespace_run(chunk.data() + i, chunk.size() - i);
+                    if (i < chunk.size()) i = structural(i);
+                    break;
+            }
+        }
+        offset_ += chunk.size();
+    }
+
+    // 入力の終わり。末尾の数値を確定させ、閉じていない構造があればエラー
+    void finish() {
+        if (state_ == State::Number) {
+            end_number(offset_);
+        }
+        if (state_ == State::String) {
+            throw ParseError("Unterminated string", offset_);
+        }
+        if (state_ != State::DocEnd) {
+            throw ParseError("Unexpected end of input", offset_);
+        }
+    }
+
+    size_t documents() const { return documents_; }
+
+private:
+    enum class State : uint8_t {
+        Value,        // 値を待っている
+        ArrayFirst,   // '[' の直後: 値か ']'
+        ObjectFirst,  // '{' の直後: キーか '}'
+        ObjectKey,    // ',' の後のキー
+        Colon,        // キーの後の ':'
+        AfterValue,   // ',' か閉じ括弧
+        DocEnd,       // トップレベルの値の後
+        String,       // 以下はトークンの途中
+        Number,
+        Literal,
+    };
+
+    size_t pos(size_t i) const { return offset_ + i; }
+
+    size_t structural(size_t i) {
+        char c = chunk_[i];
+        switch (state_) {
+            case State::ArrayFirst:
+                if (c == ']') return close_container(i, '[');
+                return begin_value(i);
+            case State::Value:
+                return begin_value(i);
+            case State::ObjectFirst:
+                if (c == '}') return close_container(i, '{');
+                [[fallthrough]];
+            case State::ObjectKey:
+                if (c != '"') throw ParseError("Expected string key", pos(i));
+                begin_string(true);
+                return i + 1;
+            case State::Colon:
+                if (c != ':') throw ParseError("Expected ':'", pos(i));
+                state_ = State::Value;
+                return i + 1;
+            case State::AfterValue: {
+                char open = stack_.back();
+                if (c == ',') {
+                    state_ = open == '[' ? State::Value : State::ObjectKey;
+                    return i + 1;
+                }
+                if ((open == '[' && c == ']') || (open == '{' && c == '}')) {
+                    return close_container(i, open);
+                }
+                throw ParseError(open == '[' ? "Expected ',' or ']'" : "Expected ',' or '}'", pos(i));
+            }
+            default:
+                return i;
+        }
+    }
+
+    size_t begin_value(size_t i) {
+        char c = chunk_[i];
+        if (c == '"') {
+            begin_string(false);
+        } else if (c == '[' || c == '{') {
+            stack_.push_back(c);
+            if (c == '[') {
+                handler_.start_array();
+                state_ = State::ArrayFirst;
+            } else {
+                handler_.start_object();
+                state_ = State::ObjectFirst;
+            }
+        } else if (c == '-' || isdigit(static_cast<unsigned char>(c))) {
+            token_.assign(1, c);
+            state_ = State::Number;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            literal_ = c == 't' ? "true" : c == 'f' ? "false" : "null";
+            literal_pos_ = 1;
+            state_ = State::Literal;
+        } else {
+            throw ParseError(string("Unexpected character: '") + c + "'", pos(i));
+        }
+        return i + 1;
+    }
+
+    void value_done() {
+        if (stack_.empty()) {
+            handler_.end_document();
+            ++documents_;
+            state_ = State::DocEnd;
+            saw_newline_ = false;
+        } else {
+            state_ = State::AfterValue;
+        }
+    }
+
+    size_t close_container(size_t i, char open) {
+        stack_.pop_back();
+        if (open == '[') {
+            handler_.end_array();
+        } else {
+            handler_.end_object();
+        }
+        value_done();
+        return i + 1;
+    }
+
+    // NDJSON では改行を挟んだ次の値を新しいドキュメントとして扱う
+    size_t between_documents(size_t i) {
+        for (; i < chunk_.size(); ++i) {
+            char c = chunk_[i];
+            if (c == '\n') {
+                saw_newline_ = true;
+            } else if (!scan::is_json_whitespace(c)) {
+                if (!ndjson_ || !saw_newline_) {
+                    throw ParseError("Unexpected characters after JSON value", pos(i));
+                }
+                state_ = State::Value;
+                return begin_value(i);
+            }
+        }
+        return i;
+    }
+
+    void begin_string(bool is_key) {
+        string_is_key_ = is_key;
+        escape_ = 0;
+        token_.clear();
+        state_ = State::String;
+    }
+
+    void emit_string(string_view text) {
+        if (string_is_key_) {
+            handler_.key(text);
+            state_ = State::Colon;
+        } else {
+            handler_.string_value(text);
+            value_done();
+        }
+    }
+
+    size_t continue_string(size_t i) {
+        while (i < chunk_.size()) {
+            if (escape_ > 0) {
+                i = continue_escape(i);
+                continue;
+            }
+            size_t run = scan::string_run(chunk_.data() + i, chunk_.size() - i);
+            // 文字列全体がこのチャンクに収まっていればコピーせずに渡す
+            if (token_.empty() && i + run < chunk_.size() && chunk_[i + run] == '"') {
+                emit_string(chunk_.substr(i, run));
+                return i + run + 1;
+            }
+            token_.append(chunk_.substr(i, run));
+            i += run;
+            if (i == chunk_.size()) break;
+
+            char c = chunk_[i++];
+            if (c == '"') {
+                emit_string(token_);
+                return i;
+            } else if (c == '\\') {
+                escape_ = 1;
+            } else {
+                throw ParseError("Control character in string", pos(i - 1));
+            }
+        }
+        return i;
+    }
+
+    // escape_: 1 = '\\' の直後, 2..5 = \u の 16 進数字を (escape_ - 2) 個読んだ
+    size_t continue_escape(size_t i) {
+        char c = chunk_[i];
+        if (escape_ == 1) {
+            if (int simple = simple_escape(c); simple >= 0) {
+                token_ += static_cast<char>(simple);
+                escape_ = 0;
+            } else if (c == 'u') {
+                codepoint_ = 0;
+                escape_ = 2;
+            } else {
+                throw ParseError(string("Invalid escape sequence: \\") + c, pos(i));
+            }
+            return i + 1;
+        }
+        int digit = hex_value(c);
+        if (digit < 0) throw ParseError("Invalid unicode escape", pos(i));
+        codepoint_ = codepoint_ * 16 + digit;
+        if (++escape_ == 6) {
+            // BasicJsonParser と同じく ASCII 範囲のみ対応
+            token_ += static_cast<char>(codepoint_);
+            escape_ = 0;
+        }
+        return i + 1;
+    }
+
+    static bool is_number_char(char c) {
+        return isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    size_t continue_number(size_t i) {
+        size_t start = i;
+        while (i < chunk_.size() && is_number_char(chunk_[i])) ++i;
+        token_.append(chunk_.substr(start, i - start));
+        if (i < chunk_.size()) end_number(pos(i));
+        return i;
+    }
+
+    // BasicJsonParser と同じ read_json_number で読む
+    void end_number(size_t at) {
+        JsonNumberToken t = read_json_number(token_);
+        if (t.error) throw ParseError(t.error, at);
+        if (t.length != token_.size()) throw ParseError("Invalid number", at);
+
+        if (t.integer) {
+            handler_.integer_value(t.i);
+        } else {
+            handler_.number_value(t.d);
+        }
+        value_done();
+    }
+
+    size_t continue_literal(size_t i) {
+        while (i < chunk_.size() && literal_pos_ < literal_.size()) {
+            if (chunk_[i] != literal_[literal_pos_]) {
+                throw ParseError(
+                    string("Expected '") + literal_[literal_pos_] + "' but got '" + chunk_[i] + "'",
+                    pos(i));
+            }
+            ++literal_pos_;
+            ++i;
+        }
+        if (literal_pos_ == literal_.size()) {
+            if (literal_[0] == 'n') {
+                handler_.null_value();
+            } else {
+                handler_.bool_value(literal_[0] == 't');
+            }
+            value_done();
+        }
+        return i;
+    }
+
+    Handler& handler_;
+    bool ndjson_;
+    State state_;
+    bool saw_newline_;
+    bool string_is_key_ = false;
+    int escape_ = 0;
+    int codepoint_ = 0;
+    string_view literal_;
+    size_t literal_pos_ = 0;
+    string token_;           // チャンクをまたいだ途中のトークン
+    vector<char> stack_;     // 開いている '[' / '{'
+    string_view chunk_;
+    size_t offset_ = 0;      // 現在のチャンク先頭の絶対位置
+    size_t documents_ = 0;
+};
+
+// istream から固定サイズのバッファで読みながらストリーミングパースする
+template<typename Handler>
+size_t parse_json_stream(istream& in, Handler& handler, bool ndjson = false) {
+    JsonStreamParser<Handler> parser(handler, ndjson);
+    vector<char> buffer(64 * 1024);
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        parser.feed(string_view(buffer.data(), static_cast<size_t>(in.gcount())));
+    }
+    parser.finish();
+    return parser.documents();
+}
+
+// === オンデマンド (遅延) アクセス ===
+// 最初に 1 回だけ文書全体を検証し、値ごとの位置を並べた索引 (テープ) を作る。
+// テープの各要素は「部分木の次の要素」を持つので、読まない部分木は一度に飛ばせる。
+// 値のデコードは呼び出し側が触ったときにだけ行う。
+class JsonLazyDocument;
+
+class JsonLazyValue {
+public:
+    JsonLazyValue() = default;
+
+    // 見つからなかった場合は false
+    explicit operator bool() const { return doc_ != nullptr; }
+
+    bool is_null() const { return first() == 'n'; }
+    bool is_bool() const { return first() == 't' || first() == 'f'; }
+    bool is_number() const { return first() == '-' || is_digit(first()); }
+    bool is_string() const { return first() == '"'; }
+    bool is_array() const { return first() == '['; }
+    bool is_object() const { return first() == '{'; }
+
+    // この値の元のテキスト
+    string_view raw() const;
+
+    bool as_bool() const {
+        if (!is_bool()) throw bad_variant_access();
+        return first() == 't';
+    }
+
+    double as_number() const {
+        JsonNumberToken t = number();
+        return t.integer ? static_cast<double>(t.i) : t.d;
+    }
+
+    int64_t as_integer() const {
+        JsonNumberToken t = number();
+        if (!t.integer) throw bad_variant_access();
+        return t.i;
+    }
+
+    string as_string() const {
+        if (!is_string()) throw bad_variant_access();
+        return decode_string(raw());
+    }
+
+    // 配列・オブジェクトの要素数（子の数だけ索引をたどる）
+    size_t size() const;
+
+    JsonLazyValue operator[](size_t index) const;
+    JsonLazyValue find(string_view key) const;
+
+    // RFC 6901 の JSON Pointer ("/a/b/0")。"" はこの値自身
+    JsonLazyValue at_pointer(string_view pointer) const;
+
+    // この部分木だけを JsonValue として構築する
+    JsonValue to_value() const {
+        if (!doc_) throw bad_variant_access();
+        return JsonParser(raw()).parse();
+    }
+
+private:
+    friend class JsonLazyDocument;
+
+    JsonLazyValue(const JsonLazyDocument* doc, size_t entry) : doc_(doc), entry_(entry) {}
+
+    char first() const;
+
+    JsonNumberToken number() const {
+        if (!is_number()) throw bad_variant_access();
+        return read_json_number(raw());
+    }
+
+    // raw は引用符を含む。エスケープがなければそのままコピー
+    static string decode_string(string_view raw) {
+        string_view body = raw.substr(1, raw.size() - 2);
+        if (body.find('\\') == string_view::npos) return string(body);
+        return JsonParser(raw).parse().as_string();
+    }
+
+    static bool key_equals(string_view raw, string_view key) {
+        string_view body = raw.substr(1, raw.size() - 2);
+        if (body.find('\\') == string_view::npos) return body == key;
+        return decode_string(raw) == key;
+    }
+
+    const JsonLazyDocument* doc_ = nullptr;
+    size_t entry_ = 0;
+};
+
+class JsonLazyDocument {
+public:
+    // input は返り値の JsonLazyDocument より長く生存している必要がある
+    explicit JsonLazyDocument(string_view input) : source_(input) {
+        Tokenizer tokenizer(input);
+        tokenizer.skip_whitespace();
+        index_value(tokenizer);
+        tokenizer.skip_whitespace();
+        if (!tokenizer.eof()) {
+            throw ParseError("Unexpected characters after JSON value", tokenizer.position());
+        }
+    }
+
+    JsonLazyValue root() const { return {this, 0}; }
+    JsonLazyValue at_pointer(string_view pointer) const { return root().at_pointer(pointer); }
+
+    string_view source() const { return source_; }
+    size_t index_size() const { return tape_.size(); }
+
+private:
+    friend class JsonLazyValue;
+
+    // オブジェクトのキーも 1 要素として並べる: { key value key value ... }
+    struct Entry {
+        size_t begin;  // 値の先頭位置
+        size_t end;    // 値の直後の位置
+        size_t next;   // 部分木の次の要素（兄弟）
+    };
+
+    // 検証しながら索引を作る。文法エラーは BasicJsonParser と同じ ParseError
+    size_t index_value(Tokenizer& tokenizer) {
+        tokenizer.skip_whitespace();
+        size_t self = tape_.size();
+        tape_.push_back({tokenizer.position(), 0, 0});
+
+        char c = tokenizer.current();
+        if (tokenizer.eof()) {
+            throw ParseError("Unexpected end of input", tokenizer.position());
+        } else if (c == '"') {
+            skip_string(tokenizer);
+        } else if (c == '[') {
+            tokenizer.advance();
+            tokenizer.skip_whitespace();
+            if (tokenizer.current() == ']') {
+                tokenizer.advance();
+            } else {
+                while (true) {
+                    index_value(tokenizer);
+                    tokenizer.skip_whitespace();
+                    char sep = tokenizer.advance();
+                    if (sep == ']') break;
+                    if (sep != ',') throw ParseError("Expected ',' or ']'", tokenizer.position() - 1);
+                }
+            }
+        } else if (c == '{') {
+            tokenizer.advance();
+            tokenizer.skip_whitespace();
+            if (tokenizer.current() == '}') {
+                tokenizer.advance();
+            } else {
+                while (true) {
+                    tokenizer.skip_whitespace();
+                    if (tokenizer.current() != '"') {
+                        throw ParseError("Expected string key", tokenizer.position());
+                    }
+                    size_t key = tape_.size();
+                    tape_.push_back({tokenizer.position(), 0, key + 1});
+                    skip_string(tokenizer);
+                    tape_[key].end = tokenizer.position();
+
+                    tokenizer.skip_whitespace();
+                    tokenizer.expect(':');
+                    index_value(tokenizer);
+                    tokenizer.skip_whitespace();
+                    char sep = tokenizer.advance();
+                    if (sep == '}') break;
+                    if (sep != ',') throw ParseError("Expected ',' or '}'", tokenizer.position() - 1);
+                }
+            }
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            string_view keyword = c == 't' ? "true" : c == 'f' ? "false" : "null";
+            if (tokenizer.rest().substr(0, keyword.size()) != keyword) {
+                throw ParseError(string("Invalid literal, expected ") + string(keyword), tokenizer.position());
+            }
+            tokenizer.skip(keyword.size());
+        } else if (c == '-' || is_digit(c)) {
+            JsonNumberToken t = read_json_number(tokenizer.rest());
+            if (t.error) throw ParseError(t.error, tokenizer.position() + t.error_at);
+            tokenizer.skip(t.length);
+        } else {
+            throw ParseError(string("Unexpected character: '") + c + "'", tokenizer.position());
+        }
+
+        tape_[self].end = tokenizer.position();
+        tape_[self].next = tape_.size();
+        return self;
+    }
+
+    // デコードせずに文字列を読み飛ばし、エスケープだけ検証する
+    static void skip_string(Tokenizer& tokenizer) {
+        tokenizer.advance();  // consume opening "
+        while (true) {
+            tokenizer.take_string_run();
+            if (tokenizer.eof()) throw ParseError("Unterminated string", tokenizer.position());
+            char c = tokenizer.advance();
+            if (c == '"') return;
+            if (c != '\\') throw ParseError("Control character in string", tokenizer.position() - 1);
+
+            char e = tokenizer.advance();
+            if (e == 'u') {
+                for (int i = 0; i < 4; ++i) {
+                    if (hex_value(tokenizer.advance()) < 0) {
+                        throw ParseError("Invalid unicode escape", tokenizer.position() - 1);
+                    }
+                }
+            } else if (simple_escape(e) < 0) {
+                throw ParseError(string("Invalid escape sequence: \\") + e, tokenizer.position());
+            }
+        }
+    }
+
+    string_view source_;
+    vector<Entry> tape_;
+};
+
+inline char JsonLazyValue::first() const {
+    if (!doc_) return '\0';
+    return doc_->source_[doc_->tape_[entry_].begin];
+}
+
+inline string_view JsonLazyValue::raw() const {
+    if (!doc_) return {};
+    const auto& e = doc_->tape_[entry_];
+    return doc_->source_.substr(e.begin, e.end - e.begin);
+}
+
+inline size_t JsonLazyValue::size() const {
+    if (!is_array() && !is_object()) return 0;
+    const auto& tape = doc_->tape_;
+    size_t count = 0;
+    for (size_t i = entry_ + 1; i < tape[entry_].next; i = tape[i].next) {
+        if (is_object()) i = tape[i].next;  // キーを飛ばして値へ
+        ++count;
+    }
+    return count;
+}
+
+inline JsonLazyValue JsonLazyValue::operator[](size_t index) const {
+    if (!is_array()) throw bad_variant_access();
+    const auto& tape = doc_->tape_;
+    for (size_t i = entry_ + 1; i < tape[entry_].next; i = tape[i].next) {
+        if (index-- == 0) return {doc_, i};
+    }
+    return {};
+}
+
+inline JsonLazyValue JsonLazyValue::find(string_view key) const {
+    if (!is_object()) throw bad_variant_access();
+    const auto& tape = doc_->tape_;
+    const string_view source = doc_->source_;
+    JsonLazyValue found;
+    // 重複キーは JsonObject と同じく後勝ちなので最後まで見る
+    for (size_t k = entry_ + 1; k < tape[entry_].next; k = tape[k + 1].next) {
+        if (key_equals(source.substr(tape[k].begin, tape[k].end - tape[k].begin), key)) {
+            found = {doc_, k + 1};
+        }
+    }
+    return found;
+}
+
+inline JsonLazyValue JsonLazyValue::at_pointer(string_view pointer) const {
+    if (pointer.empty()) return *this;
+    if (pointer[0] != '/') throw invalid_argument("JSON pointer must start with '/'");
+
+    JsonLazyValue current = *this;
+    size_t start = 1;
+    while (current) {
+        size_t slash = pointer.find('/', start);
+        string_view raw_token = pointer.substr(start, slash == string_view::npos ? string_view::npos : slash - start);
+
+        // ~1 → '/', ~0 → '~'
+        string token;
+        for (size_t i = 0; i < raw_token.size(); ++i) {
+            if (raw_token[i] == '~' && i + 1 < raw_token.size() && (raw_token[i + 1] == '0' || raw_token[i + 1] == '1')) {
+                token += raw_token[++i] == '0' ? '~' : '/';
+            } else {
+                token += raw_token[i];
+            }
+        }
+
+        if (current.is_object()) {
+            current = current.find(token);
+        } else if (current.is_array()) {
+            // 先頭の 0 は "0" 自身以外は認めない
+            bool valid = !token.empty() && all_of(token.begin(), token.end(), is_digit) &&
+                         (token.size() == 1 || token[0] != '0');
+            size_t index = 0;
+            if (valid) {
+                auto [ptr, ec] = from_chars(token.data(), token.data() + token.size(), index);
+                valid = ec == errc();
+            }
+            current = valid ? current[index] : JsonLazyValue();
+        } else {
+            return {};
+        }
+
+        if (slash == string_view::npos) break;
+        start = slash + 1;
+    }
+    return current;
+}
+
+// === 便利関数 ===
+JsonValue parse_json(string_view input) {
+    return JsonParser(input).parse();
+}
+
+// input は返り値の JsonViewDocument より長く生存している必要がある
+JsonViewDocument parse_json_view(string_view input) {
+    JsonViewDocument doc;
+    doc.source_ = input;
+    doc.root_ = BasicJsonParser<JsonViewBuilder>(input, JsonViewBuilder{&doc}).parse();
+    return doc;
+}
+
+// 検証と索引づけだけ行い、値は触ったときにデコードする
+JsonLazyDocument parse_json_lazy(string_view input) {
+    return JsonLazyDocument(input);
+}
+
+// ファイルを mmap してビューモードでパースする
+JsonViewDocument parse_json_file(const string& path) {
+    JsonViewDocument doc;
+    doc.mapping_ = make_unique<MappedFile>(path);
+    doc.source_ = doc.mapping_->view();
+    doc.root_ = BasicJsonParser<JsonViewBuilder>(doc.source_, JsonViewBuilder{&doc}).parse();
+    return doc;
+}
+
+
+
+// === 並列バッチパース ===
+// concepts/concurrency のスレッドプールと同じ構成（チャレンジは単体で動くので複製している）
+class ThreadPool {
+public:
+    ThreadPool(size_t num_threads) : stop_(false) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this]() {
+                while (true) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> lock(mtx_);
+                        cv_.wait(lock, [this]() {
+                            return stop_ || !tasks_.empty();
+                        });
+                        if (stop_ && tasks_.empty()) return;
+                        task = move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    template<typename F>
+    future<void> enqueue(F&& f) {
+        auto task = make_shared<packaged_task<void()>>(forward<F>(f));
+        future<void> result = task->get_future();
+        {
+            lock_guard<mutex> lock(mtx_);
+            tasks_.emplace([task]() { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+private:
+    vector<thread> workers_;
+    queue<function<void()>> tasks_;
+    mutex mtx_;
+    condition_variable cv_;
+    bool stop_;
+};
+
+// NDJSON の 1 レコード分の結果。error の位置はそのレコードの先頭からの位置
+struct JsonBatchResult {
+    size_t line;      // 1 始まりの行番号
+    size_t offset;    // バッファ内でのレコードの開始位置
+    optional<JsonValue> value;
+    optional<ParseError> error;
+
+    bool ok() const { return value.has_value(); }
+};
+
+// buffer をおよそ chunk_bytes ごとにレコード境界（改行）で区切り、
+// 区間ごとにプールで並列にパースする。結果は入力の順で、空行は飛ばす。
+vector<JsonBatchResult> parse_ndjson_parallel(string_view buffer, ThreadPool& pool,
+                                              size_t chunk_bytes = 1 << 20) {
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        size_t lines = 0;  // 区間内の行数（行番号を後で通しにする）
+        vector<JsonBatchResult> results;
+    };
+
+    // 区間の終わりを次の改行の直後まで伸ばす
+    vector<Chunk> chunks;
+    for (size_t begin = 0; begin < buffer.size();) {
+        size_t end = min(buffer.size(), begin + max<size_t>(chunk_bytes, 1));
+        if (end < buffer.size()) {
+            size_t newline = buffer.find('\n', end - 1);
+            end = newline == string_view::npos ? buffer.size() : newline + 1;
+        }
+        chunks.push_back({begin, end, 0, {}});
+        begin = end;
+    }
+
+    vector<future<void>> futures;
+    futures.reserve(chunks.size());
+    for (Chunk& chunk : chunks) {
+        futures.push_back(pool.enqueue([&chunk, buffer]() {
+            size_t pos = chunk.begin;
+            while (pos < chunk.end) {
+                const void* nl = memchr(buffer.data() + pos, '\n', chunk.end - pos);
+                size_t line_end = nl ? static_cast<size_t>(static_cast<const char*>(nl) - buffer.data()) : chunk.end;
+                string_view record = buffer.substr(pos, line_end - pos);
+                ++chunk.lines;
+
+                if (scan::whitespace_run(record.data(), record.size()) < record.size()) {
+                    JsonBatchResult result{chunk.lines, pos, nullopt, nullopt};
+                    try {
+                        result.value = parse_json(record);
+                    } catch (const ParseError& e) {
+                        result.error = e;
+                    }
+                    chunk.results.push_back(move(result));
+                }
+                pos = line_end + 1;
+            }
+        }));
+    }
+    // ParseError 以外の例外 (bad_alloc など) はここで再送出される
+    for (auto& f : futures) f.get();
+
+    vector<JsonBatchResult> results;
+    size_t total = 0;
+    for (const Chunk& chunk : chunks) total += chunk.results.size();
+    results.reserve(total);
+
+    size_t lines_before = 0;
+    for (Chunk& chunk : chunks) {
+        for (JsonBatchResult& r : chunk.results) {
+            r.line += lines_before;
+            results.push_back(move(r));
+        }
+        lines_before += chunk.lines;
+    }
+    return results;
+}
+
+vector<JsonBatchResult> parse_ndjson_parallel(string_view buffer,
+                                              size_t num_threads = thread::hardware_concurrency()) {
+    ThreadPool pool(max<size_t>(num_threads, 1));
+    return parse_ndjson_parallel(buffer, pool);
+}
+
+// === JSON 文字列化 ===
+// 1 つのバッファに追記していく。再帰ごとの一時文字列やストリームは作らない。
+// indent = 0 なら空白なしのコンパクト形式、> 0 なら整形して出力する。
+// fd を渡すとバッファが flush_threshold を超えるたびに write(2) で書き出す。
+class JsonWriter {
+public:
+    static constexpr size_t flush_threshold = 64 * 1024;
+
+    explicit JsonWriter(int indent = 0, int fd = -1) : indent_(indent), fd_(fd) {}
+
+    ~JsonWriter() {
+        if (fd_ >= 0) {
+            try { flush(); } catch (...) {}
+        }
+    }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void write(const JsonValue& value) {
+        if (value.is_null()) {
+            write_null();
+        } else if (value.is_bool()) {
+            write_bool(value.as_bool());
+        } else if (value.is_integer()) {
+            write_integer(value.as_integer());
+        } else if (value.is_number()) {
+            write_number(value.as_number());
+        } else if (value.is_string()) {
+            write_string(value.as_string());
+        } else if (value.is_array()) {
+            begin_array();
+            for (const auto& item : value.as_array()) write(item);
+            end_array();
+        } else {
+            begin_object();
+            for (const auto& [k, v] : value.as_object()) {
+                key(k);
+                write(v);
+            }
+            end_object();
+        }
+    }
+
+    void write_null() { element(); out_ += "null"; done(); }
+    void write_bool(bool b) { element(); out_ += b ? "true" : "false"; done(); }
+    void write_number(double d) { element(); append_json_number(out_, d); done(); }
+    void write_integer(int64_t i) { element(); append_json_number(out_, i); done(); }
+    void write_string(string_view s) { element(); append_quoted(s); done(); }
+
+    void begin_array() { open('['); }
+    void end_array() { close(']'); }
+    void begin_object() { open('{'); }
+    void end_object() { close('}'); }
+
+    void key(string_view k) {
+        element();
+        append_quoted(k);
+        out_ += ':';
+        if (indent_ > 0) out_ += ' ';
+        after_key_ = true;
+    }
+
+    const string& str() const { return out_; }
+    string take() { return exchange(out_, string()); }
+
+    // バッファの内容を fd に書き出す
+    void flush() {
+        size_t written = 0;
+        while (written < out_.size()) {
+            ssize_t n = ::write(fd_, out_.data() + written, out_.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw system_error(errno, generic_category(), "JsonWriter::flush");
+            }
+            written += static_cast<size_t>(n);
+        }
+        out_.clear();
+    }
+
+    // '"' '\\' 制御文字をエスケープする。それ以外の区間は SIMD で探してまとめてコピー
+    static void append_escaped(string& out, string_view s) {
+        static constexpr char hex[] = "0123456789abcdef";
+        size_t i = 0;
+        while (i < s.size()) {
+            size_t run = scan::string_run(s.data() + i, s.size() - i);
+            out.append(s.data() + i, run);
+            i += run;
+            if (i == s.size()) break;
+
+            unsigned char c = static_cast<unsigned char>(s[i++]);
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                case '\r': out += "\\r"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                    break;
+            }
+        }
+    }
+
+private:
+    void append_quoted(string_view s) {
+        out_ += '"';
+        append_escaped(out_, s);
+        out_ += '"';
+    }
+
+    // 要素の前の ',' と改行・インデント
+    void element() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (first_.empty()) return;
+        if (!first_.back()) out_ += ',';
+        first_.back() = false;
+        newline();
+    }
+
+    void done() {
+        if (fd_ >= 0 && out_.size() >= flush_threshold) flush();
+    }
+
+    void newline() {
+        if (indent_ > 0) {
+            out_ += '\n';
+            out_.append(first_.size() * static_cast<size_t>(indent_), ' ');
+        }
+    }
+
+    void open(char bracket) {
+        element();
+        out_ += bracket;
+        first_.push_back(true);
+    }
+
+    void close(char bracket) {
+        bool empty = first_.back();
+        first_.pop_back();
+        if (!empty) newline();
+        out_ += bracket;
+        done();
+    }
+
+    int indent_;
+    int fd_;
+    string out_;
+    vector<bool> first_;  // 開いている配列・オブジェクトごとに「まだ要素がない」か
+    bool after_key_ = false;
+};
+
+string stringify(const JsonValue& value, int indent = 0) {
+    JsonWriter writer(indent);
+    writer.write(value);
+    return writer.take();
+}
+
+// === デモ ===
+void demo() {
+    vector<string> examples = {
+        "null",
+        "true",
+        "42",
+        "3.14",
+        "\"hello\"",
+        "[1, 2, 3]",
+        "{\"name\": \"C++\", \"version\": 20}",
+        "{\"nested\": {\"array\": [1, true, null]}}"
+    };
+
+    for (const auto& json : examples) {
+        cout << "Input:  " << json << endl;
+        try {
+            JsonValue result = parse_json(json);
+            cout << "Parsed: " << stringify(result) << endl;
+        } catch (const ParseError& e) {
+            cout << "Error:  " << e.what() << endl;
+        }
+        cout << endl;
+    }
+}
+
+// === テスト ===
+void run_tests() {
+    cout << "--- Tests ---" << endl;
+
+    // null
+    assert(parse_json("null").is_null());
+
+    // bool
+    assert(parse_json("true").as_bool() == true);
+    assert(parse_json("false").as_bool() == false);
+
+    // number
+    assert(parse_json("42").as_number() == 42);
+    assert(parse_json("-17").as_number() == -17);
+    assert(parse_json("3.14").as_number() == 3.14);
+    assert(parse_json("1e10").as_number() == 1e10);
+
+    // 整数は int64 のまま、範囲外や小数は double
+    assert(parse_json("9007199254740993").as_integer() == 9007199254740993LL);
+    assert(parse_json("-9223372036854775808").as_integer() == numeric_limits<int64_t>::min());
+    assert(!parse_json("9223372036854775808").is_integer());
+    assert(parse_json("9223372036854775808").as_number() == 9223372036854775808.0);
+    assert(!parse_json("1.0").is_integer());
+    assert(signbit(parse_json("-0").as_number()));
+    assert(parse_json("0.1").as_number() == 0.1);
+    assert(parse_json("-1.5e-3").as_number() == -1.5e-3);
+    assert(parse_json("123456789012345678901234567890").as_number() == 1.2345678901234568e29);
+    assert(parse_json("2.2250738585072014e-308").as_number() == 2.2250738585072014e-308);
+    assert(parse_json("1e400").as_number() == numeric_limits<double>::infinity());
+    // 下位あふれは inf ではなく 0（符号は保つ）、非正規化数はそのまま
+    assert(parse_json("1e-400").as_number() == 0.0 && !signbit(parse_json("1e-400").as_number()));
+    assert(parse_json("-1e-400").as_number() == 0.0 && signbit(parse_json("-1e-400").as_number()));
+    assert(parse_json("4.9e-325").as_number() == 0.0);
+    assert(parse_json("0.000001e-320").as_number() == 0.0);
+    assert(parse_json("1e-310").as_number() == 1e-310);
+    assert(parse_json("-123456.789e400").as_number() == -numeric_limits<double>::infinity());
+    assert(parse_json("0.0001e313").as_number() == numeric_limits<double>::infinity());
+    assert(parse_json("0.30000000000000004").as_number() == 0.30000000000000004);
+    assert(parse_json("1000000000000000000000000e-24").as_number() == 1.0);
+
+    // 往復して同じ値になる最短表現
+    for (const char* num : {"0.1", "3.14", "1e+100", "5e-324", "0.30000000000000004", "-2.5", "123456789", "-7"}) {
+        assert(stringify(parse_json(num)) == num);
+    }
+    assert(stringify(JsonValue(1.0 / 3)) == "0.3333333333333333");
+
+    // string
+    assert(parse_json("\"hello\"").as_string() == "hello");
+    assert(parse_json("\"hello\\nworld\"").as_string() == "hello\nworld");
+
+    // array
+    assert(parse_json("[]").as_array().empty());
+    assert(parse_json("[1, 2, 3]").as_array().size() == 3);
+
+    // object
+    assert(parse_json("{}").as_object().empty());
+    auto obj = parse_json("{\"name\": \"C++\"}").as_object();
+    assert(obj["name"].as_string() == "C++");
+
+    // nested
+    auto nested = parse_json("{\"arr\": [1, {\"nested\": true}]}");
+    assert(nested.as_object().at("arr").as_array()[1].as_object().at("nested").as_bool() == true);
+
+    // whitespace
+    auto ws = parse_json("  { \"key\" : \"value\" }  ");
+    assert(ws.as_object().at("key").as_string() == "value");
+
+    // 長い文字列・空白（SIMD の 16/32 バイト境界をまたぐ）
+    string long_text(100, 'a');
+    long_text[70] = '\\';
+    long_text[71] = 'n';
+    string long_json = "  \n\t " + string(40, ' ') + "[\"" + long_text + "\", \"\u00e9t\u00e9\"]" + string(33, '\n');
+    auto long_arr = parse_json(long_json).as_array();
+    assert(long_arr[0].as_string() == string(70, 'a') + "\n" + string(28, 'a'));
+    assert(long_arr[1].as_string() == "\u00e9t\u00e9");
+    for (size_t n = 0; n < 70; ++n) {
+        string s = "\"" + string(n, 'x') + "\"";
+        assert(parse_json(s).as_string() == string(n, 'x'));
+    }
+
+    // ビューモード: エスケープなしの文字列とキーは入力を指す
+    string view_src = "{\"name\": \"C++\", \"esc\\n\": \"a\\tb\", \"list\": [\"x\", 1, false, null]}";
+    JsonViewDocument view_doc = parse_json_view(view_src);
+    const JsonViewValue& view_root = view_doc.root();
+    string_view view_name = view_root.find("name")->as_string();
+    assert(view_name == "C++");
+    assert(view_name.data() >= view_src.data() && view_name.data() < view_src.data() + view_src.size());
+    assert(view_root.find("esc\n")->as_string() == "a\tb");
+    assert(view_doc.decoded_count() == 2);
+    assert(view_root.as_object()[0].first.data() == view_src.data() + 2);
+    assert(view_root.find("list")->as_array().size() == 4);
+    assert(view_root.find("missing") == nullptr);
+    JsonViewDocument moved_doc = move(view_doc);
+    assert(moved_doc.root().find("esc\n")->as_string() == "a\tb");
+
+    // mmap
+    char tmpl[] = "/tmp/json_parser_testXXXXXX";
+    int tmp_fd = mkstemp(tmpl);
+    assert(tmp_fd >= 0);
+    [[maybe_unused]] ssize_t written = write(tmp_fd, view_src.data(), view_src.size());
+    assert(written == static_cast<ssize_t>(view_src.size()));
+    close(tmp_fd);
+    {
+        JsonViewDocument file_doc = parse_json_file(tmpl);
+        assert(file_doc.root().find("list")->as_array()[0].as_string() == "x");
+    }
+    unlink(tmpl);
+
+    // アリーナ DOM
+    string arena_src = "{\"b\": [1, \"two\", {\"b\": null}], \"a\": true, \"a\": false, \"s\\u0041\": \"x\\ny\"}";
+    JsonArenaDocument arena_doc = parse_json_arena(arena_src);
+    const JsonNode& arena_root = arena_doc.root();
+    assert(sizeof(JsonNode) == 16);
+    assert(arena_root.size() == 4);
+    assert(arena_root.members()[0].key == "b");                   // 出現順
+    assert(arena_root.members()[0].key.data() ==
+           arena_root.find("b")->items()[2].members()[0].key.data());  // インターン済み
+    assert(arena_root.find("a")->as_bool() == false);
+    assert(arena_root.find("sA")->as_string() == "x\ny");
+    assert((*arena_root.find("b"))[1].as_string() == "two");
+    assert(arena_root.find("nope") == nullptr);
+    assert(stringify(arena_root.to_value()) == stringify(parse_json(arena_src)));
+
+    string wide = "{";
+    for (int i = 0; i < 100; ++i) {
+        wide += (i ? ", \"k" : "\"k") + to_string(i) + "\": " + to_string(i);
+    }
+    wide += ", \"k7\": -1}";
+    JsonArenaDocument wide_doc = parse_json_arena(wide);
+    for (int i = 0; i < 100; ++i) {
+        assert(wide_doc.root().find("k" + to_string(i))->as_number() == (i == 7 ? -1 : i));
+    }
+    assert(wide_doc.root().find("k100") == nullptr);
+    assert(wide_doc.root().size() == 101);
+
+    // upstream を渡すと、アリーナのブロックはそこから取られる
+    struct CountingUpstream : pmr::memory_resource {
+        size_t calls = 0;
+        void* do_allocate(size_t n, size_t align) override {
+            ++calls;
+            return pmr::new_delete_resource()->allocate(n, align);
+        }
+        void do_deallocate(void* p, size_t n, size_t align) override {
+            pmr::new_delete_resource()->deallocate(p, n, align);
+        }
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+    } upstream;
+    {
+        JsonArenaDocument counted = parse_json_arena(wide, &upstream);
+        assert(counted.root().find("k7")->as_integer() == -1);
+    }
+    assert(upstream.calls >= 1 && upstream.calls <= 4);
+
+    // ストリーミング: どこで区切っても同じイベント列になる
+    struct EventLog {
+        string log;
+        void null_value() { log += "null "; }
+        void bool_value(bool b) { log += b ? "true " : "false "; }
+        void number_value(double d) { log += "n" + to_string(d) + " "; }
+        void integer_value(int64_t i) { log += "i" + to_string(i) + " "; }
+        void string_value(string_view s) { log += "s:" + string(s) + " "; }
+        void key(string_view s) { log += "k:" + string(s) + " "; }
+        void start_object() { log += "{ "; }
+        void end_object() { log += "} "; }
+        void start_array() { log += "[ "; }
+        void end_array() { log += "] "; }
+        void end_document() { log += "| "; }
+    };
+    string stream_src = "{\"a\": [1, -2.5e3, true, null, \"x\\\"y\"], \"b\": {}, \"c\\u0041\": \"\\t\", \"d\": []}";
+    EventLog whole;
+    JsonStreamParser<EventLog> whole_parser(whole);
+    whole_parser.feed(stream_src);
+    whole_parser.finish();
+    assert(whole.log == "{ k:a [ i1 n-2500.000000 true null s:x\"y ] k:b { } k:cA s:\t k:d [ ] } | ");
+    for (size_t cut = 0; cut <= stream_src.size(); ++cut) {
+        EventLog split;
+        JsonStreamParser<EventLog> split_parser(split);
+        split_parser.feed(string_view(stream_src).substr(0, cut));
+        split_parser.feed(string_view(stream_src).substr(cut));
+        split_parser.finish();
+        assert(split.log == whole.log);
+    }
+    EventLog bytes;
+    JsonStreamParser<EventLog> byte_parser(bytes);
+    for (char c : stream_src) byte_parser.feed(string_view(&c, 1));
+    byte_parser.finish();
+    assert(bytes.log == whole.log);
+
+    // 末尾の数値は finish() で確定する
+    EventLog number_log;
+    JsonStreamParser<EventLog> number_parser(number_log);
+    number_parser.feed("4");
+    number_parser.feed("2");
+    number_parser.finish();
+    assert(number_log.log == "i42 | ");
+
+    // NDJSON
+    istringstream ndjson_in("1\n{\"a\": \"b\"}\n\n[true]\n");
+    EventLog ndjson_log;
+    assert(parse_json_stream(ndjson_in, ndjson_log, true) == 3);
+    assert(ndjson_log.log == "i1 | { k:a s:b } | [ true ] | ");
+
+    for (const char* bad : {"[1,]", "{\"a\" 1}", "[1", "\"abc", "1 2", "tru", "01", "[1}"}) {
+        EventLog ignored;
+        JsonStreamParser<EventLog> bad_parser(ignored);
+        try {
+            bad_parser.feed(bad);
+            bad_parser.finish();
+            assert(false && "invalid stream should fail");
+        } catch (const ParseError&) {}
+    }
+    try {
+        EventLog ignored;
+        JsonStreamParser<EventLog> bad_parser(ignored, true);
+        bad_parser.feed("1 2\n");
+        assert(false && "two records on one line should fail");
+    } catch (const ParseError& e) {
+        assert(e.position() == 2);
+    }
+
+    // オンデマンドアクセスと JSON Pointer
+    string lazy_src = "{\"a\": {\"b\": [10, {\"c~d/e\": \"x\"}, -1.5]}, \"big\": [" + string(50, ' ');
+    for (int i = 0; i < 1000; ++i) lazy_src += (i ? ",{\"n\":[" : "{\"n\":[") + to_string(i) + "]}";
+    lazy_src += "], \"s\": \"t\\u0041\", \"k\\\"q\": true, \"dup\": 1, \"dup\": null}";
+    JsonLazyDocument lazy = parse_json_lazy(lazy_src);
+    assert(lazy.root().is_object());
+    assert(lazy.at_pointer("").raw() == lazy_src);
+    assert(lazy.at_pointer("/a/b/0").as_integer() == 10);
+    assert(lazy.at_pointer("/a/b/2").as_number() == -1.5);
+    assert(lazy.at_pointer("/a/b/1/c~0d~1e").as_string() == "x");
+    assert(!lazy.at_pointer("/a/b/3"));
+    assert(!lazy.at_pointer("/a/b/01"));
+    assert(!lazy.at_pointer("/a/missing/0"));
+    assert(!lazy.at_pointer("/a/b/0/x"));
+    assert(lazy.at_pointer("/s").as_string() == "tA");
+    assert(lazy.at_pointer("/k\"q").as_bool());
+    assert(lazy.at_pointer("/dup").is_null());
+    assert(lazy.at_pointer("/big").size() == 1000);
+    assert(lazy.at_pointer("/big/999/n/0").as_integer() == 999);
+    assert(lazy.root().size() == 6);
+    assert(stringify(lazy.at_pointer("/a").to_value()) == "{\"b\":[10,{\"c~d/e\":\"x\"},-1.5]}");
+    for (const char* bad : {"{\"a\": [1, 2}", "[tru]", "{\"a\" 1}", "[\"\\x\"]", "[1] 2", ""}) {
+        try {
+            parse_json_lazy(bad);
+            assert(false && "invalid lazy input should fail");
+        } catch (const ParseError&) {}
+    }
+
+    // 並列バッチパース: 入力順の結果とレコードごとのエラー
+    string batch;
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 97 == 0) {
+            batch += "{\"id\": x}\n";
+        } else if (i % 89 == 0) {
+            batch += "   \n";
+        } else {
+            batch += "{\"id\": " + to_string(i) + ", \"tags\": [\"t" + to_string(i % 7) + "\"]}\r\n";
+        }
+    }
+    batch += "[1, 2]";  // 最終行は改行なし
+    ThreadPool batch_pool(4);
+    auto batch_results = parse_ndjson_parallel(batch, batch_pool, 256);
+    size_t expected_records = 0;
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 97 == 0 || i % 89 != 0) ++expected_records;
+    }
+    assert(batch_results.size() == expected_records + 1);
+    size_t result_index = 0;
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 97 != 0 && i % 89 == 0) continue;
+        const JsonBatchResult& r = batch_results[result_index++];
+        assert(r.line == static_cast<size_t>(i) + 1);
+        if (i % 97 == 0) {
+            assert(!r.ok() && r.error->position() == 7);
+        } else {
+            assert(r.ok() && r.value->as_object().at("id").as_integer() == i);
+        }
+    }
+    assert(batch_results.back().value->as_array().size() == 2);
+    assert(batch_results.back().offset == batch.size() - 6);
+    assert(parse_ndjson_parallel("", batch_pool).empty());
+    assert(parse_ndjson_parallel("1\n2\n", 2).size() == 2);
+
+    // 文字列化: エスケープ・コンパクト形式・整形
+    JsonValue escaped = JsonObject{{"q\"k", JsonString("a\"b\\c\n\x01\u00e9")}, {"list", JsonArray{1, 2.5, nullptr, JsonArray{}, JsonObject{}}}};
+    assert(stringify(escaped) == "{\"list\":[1,2.5,null,[],{}],\"q\\\"k\":\"a\\\"b\\\\c\\n\\u0001\u00e9\"}");
+    assert(stringify(parse_json(stringify(escaped))) == stringify(escaped));
+    assert(stringify(parse_json("{\"a\": [1, {\"b\": true}]}"), 2) ==
+           "{\n  \"a\": [\n    1,\n    {\n      \"b\": true\n    }\n  ]\n}");
+
+    // fd へのストリーミング出力
+    int pipe_fds[2];
+    [[maybe_unused]] int pipe_rc = pipe(pipe_fds);
+    assert(pipe_rc == 0);
+    {
+        JsonWriter fd_writer(0, pipe_fds[1]);
+        fd_writer.begin_array();
+        fd_writer.write_string("x");
+        fd_writer.write_integer(-3);
+        fd_writer.end_array();
+    }
+    close(pipe_fds[1]);
+    char pipe_buf[32];
+    ssize_t pipe_len = read(pipe_fds[0], pipe_buf, sizeof(pipe_buf));
+    close(pipe_fds[0]);
+    assert(string_view(pipe_buf, static_cast<size_t>(pipe_len)) == "[\"x\",-3]");
+
+    // errors
+    try {
+        parse_json("");
+        assert(false && "empty input should fail");
+    } catch (const ParseError&) {}
+
+    try {
+        parse_json("\"tab\there\"");
+        assert(false && "raw control character should fail");
+    } catch (const ParseError&) {}
+
+    try {
+        parse_json("{");
+        assert(false && "unclosed object should fail");
+    } catch (const ParseError&) {}
+
+    cout << "All tests passed!" << endl;
+}
+
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json] [file.json ...]` で実行する。
+// よく使われる JSON ベンチマークのコーパス (twitter / canada / citm_catalog) と同じ傾向のデータを作る。
+// 実データで測るときはファイルを引数に渡す
+namespace corpus {
+
+// 再現できるように固定シードの線形合同法
+struct Lcg {
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    uint64_t next() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state >> 33;
+    }
+    uint64_t below(uint64_t n) { return next() % n; }
+};
+
+// 文字列が多く、エスケープと非 ASCII を含むオブジェクトの配列（twitter 風）
+string tweets(size_t count) {
+    static const char* const words[] = {"C++", "json", "parser", "benchmark", "こんにちは", "世界",
+                                        "fast", "\\\"quoted\\\"", "line\\nbreak", "\\u00e9t\\u00e9"};
+    Lcg rng;
+    string out = "{\"statuses\":[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) out += ',';
+        string text;
+        for (int w = 0; w < 12; ++w) {
+            if (w > 0) text += ' ';
+            text += words[rng.below(size(words))];
+        }
+        out += "{\"id\":" + to_string(505874924095815681ull + rng.next()) +
+               ",\"created_at\":\"Sun Aug 31 00:29:15 +0000 2014\",\"text\":\"" + text +
+               "\",\"truncated\":false,\"user\":{\"id\":" + to_string(rng.next()) +
+               ",\"name\":\"user" + to_string(i) + "\",\"screen_name\":\"u" + to_string(i) +
+               "\",\"followers_count\":" + to_string(rng.below(100000)) +
+               ",\"verified\":" + (rng.below(2) ? "true" : "false") +
+               "},\"entities\":{\"hashtags\":[{\"text\":\"cpp\",\"indices\":[0,4]}],\"urls\":[]}"
+               ",\"retweet_count\":" + to_string(rng.below(1000)) +
+               ",\"coordinates\":null,\"lang\":\"ja\"}";
+    }
+    return out + "]}";
+}
+
+// 浮動小数点数の座標がほとんどを占める（canada 風）
+string geometry(size_t points) {
+    Lcg rng;
+    string out = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                 "\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\","
+                 "\"coordinates\":[[";
+    char number[32];
+    for (size_t i = 0; i < points; ++i) {
+        if (i > 0) out += ',';
+        double lon = -141.0 + rng.below(1u << 30) / double(1u << 30) * 90.0;
+        double lat = 41.0 + rng.below(1u << 30) / double(1u << 30) * 42.0;
+        out += '[';
+        out.append(number, snprintf(number, sizeof(number), "%.15g", lon));
+        out += ',';
+        out.append(number, snprintf(number, sizeof(number), "%.15g", lat));
+        out += ']';
+    }
+    return out + "]]}}]}";
+}
+
+// 数字のキー、整数の配列、null が多いオブジェクト（citm_catalog 風）
+string catalog(size_t count) {
+    Lcg rng;
+    string out = "{\"events\":{";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) out += ',';
+        string id = to_string(138586341 + i);
+        out += "\"" + id + "\":{\"description\":null,\"id\":" + id +
+               ",\"logo\":null,\"name\":\"Event " + id + "\",\"subTopicIds\":[";
+        for (int t = 0; t < 6; ++t) {
+            if (t > 0) out += ',';
+            out += to_string(337184262 + rng.below(1000));
+        }
+        out += "],\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[" +
+               to_string(324846099 + rng.below(100)) + "," + to_string(107888604 + rng.below(100)) +
+               "]}";
+    }
+    return out + "}}";
+}
+
+}  // namespace corpus
+
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("json_parser", options);
+
+    vector<pair<string, string>> corpora = {
+        {"tweets", corpus::tweets(2000)},
+        {"geometry", corpus::geometry(60000)},
+        {"catalog", corpus::catalog(8000)},
+    };
+    for (const string& path : options.inputs) {
+        MappedFile file(path);
+        string name = path.substr(path.find_last_of('/') + 1);
+        corpora.emplace_back(name.substr(0, name.rfind('.')), string(file.view()));
+    }
+
+    for (const auto& [name, text] : corpora) {
+        string_view input = text;
+        double bytes = static_cast<double>(text.size());
+        runner.run("parse_json/" + name, bytes, "B", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(parse_json(input));
+        });
+        runner.run("parse_json_view/" + name, bytes, "B", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(parse_json_view(input));
+        });
+        runner.run("parse_json_arena/" + name, bytes, "B", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(parse_json_arena(input));
+        });
+        runner.run("parse_json_lazy/" + name, bytes, "B", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(parse_json_lazy(input));
+        });
+
+        JsonValue value = parse_json(input);
+        for (int indent : {0, 2}) {
+            double out_bytes = static_cast<double>(stringify(value, indent).size());
+            runner.run("stringify" + string(indent ? "_indent/" : "/") + name, out_bytes, "B",
+                       [&](uint64_t n) {
+                           for (uint64_t i = 0; i < n; ++i) bench::keep(stringify(value, indent));
+                       });
+        }
+    }
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        try {
+            run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
     cout << "=== JSON Parser Demo ===" << endl << endl;
+    cout << "Scanner: " << scan::dispatch().name << endl << endl;
 
     demo();
     run_tests();
@@ -1,17 +1,68 @@
 // CLI Tool - C++ 実装 (TODO管理ツール)
 
 #include <iostream>
+#include <iomanip>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <optional>
 #include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <cctype>
 #include <filesystem>
+#include <memory>
+#include <functional>
+#include <string_view>
+#include <charconv>
+#include <stdexcept>
+#include <system_error>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 namespace fs = filesystem;
 
+// === TaskView ===
+// ファイル上の 1 行を指すビュー。説明はコピーしない
+struct TaskView {
+    int id;
+    string_view description;
+    bool done;
+
+    // 行の形式は "<id> [ ] 説明"。ID のない古い形式 ("[ ] 説明" や説明だけ) は
+    // fallback_id を使う（直前の行の ID + 1 を渡すと、従来どおり 1, 2, ... になる）。
+    // 数字を ID とみなすのはチェックボックスが続くときだけ ("2024 [draft] plan" は説明のまま)
+    static TaskView from_line(int fallback_id, string_view line) {
+        int id = fallback_id;
+        size_t digits = 0;
+        while (digits < line.size() && isdigit(static_cast<unsigned char>(line[digits]))) ++digits;
+        string_view rest = line.substr(digits);
+        if (digits > 0 && (rest.substr(0, 5) == " [ ] " || rest.substr(0, 5) == " [x] ")) {
+            from_chars(line.data(), line.data() + digits, id);
+            line.remove_prefix(digits + 1);
+        }
+
+        if (line.substr(0, 4) == "[x] ") {
+            return TaskView{id, line.substr(4), true};
+        } else if (line.substr(0, 4) == "[ ] ") {
+            return TaskView{id, line.substr(4), false};
+        }
+        return TaskView{id, line, false};
+    }
+};
+
 // === Task ===
 struct Task {
     int id;
@@ -19,186 +70,886 @@ struct Task {
     bool done;
 
     string to_line() const {
-        return (done ? "[x] " : "[ ] ") + description;
+        return to_string(id) + (done ? " [x] " : " [ ] ") + description;
     }
 
-    static Task from_line(int id, const string& line) {
-        Task task;
-        task.id = id;
+    static Task from_line(int id, string_view line) {
+        TaskView view = TaskView::from_line(id, line);
+        return Task{view.id, string(view.description), view.done};
+    }
+};
 
-        if (line.substr(0, 4) == "[x] ") {
-            task.done = true;
-            task.description = line.substr(4);
-        } else if (line.substr(0, 4) == "[ ] ") {
-            task.done = false;
-            task.description = line.substr(4);
-        } else {
-            task.done = false;
-            task.description = line;
+// === MappedFile ===
+// 読み取り専用の mmap。ファイルがなければ空
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            if (errno == ENOENT) return;
+            throw system_error(errno, generic_category(), "open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_ = static_cast<size_t>(st.st_size);
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw system_error(errno, generic_category(), "mmap " + path);
+            }
+            madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
         }
+        ::close(fd);
+    }
 
-        return task;
+    ~MappedFile() {
+        if (data_) munmap(const_cast<char*>(data_), size_);
     }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    string_view view() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// 空行を除いた各行を memchr で切り出して渡す
+template<typename F>
+void for_each_line(string_view data, F&& f) {
+    const char* p = data.data();
+    const char* end = p + data.size();
+    while (p < end) {
+        const char* nl = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* line_end = nl ? nl : end;
+        if (line_end > p) f(string_view(p, static_cast<size_t>(line_end - p)));
+        p = line_end + 1;
+    }
+}
+
+// 一時ファイルに書いて fsync し、rename で置き換える。
+// 途中で落ちても、元のファイルか新しいファイルのどちらかが完全な形で残る
+void write_file_atomically(const string& path, string_view data) {
+    auto fail = [](const string& what) {
+        throw system_error(errno, generic_category(), what);
+    };
+    string tmp_path = path + ".tmp." + to_string(getpid());
+
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) fail("open " + tmp_path);
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            ::unlink(tmp_path.c_str());
+            fail("write " + tmp_path);
+        }
+        written += static_cast<size_t>(n);
+    }
+    if (fsync(fd) < 0) {
+        ::close(fd);
+        ::unlink(tmp_path.c_str());
+        fail("fsync " + tmp_path);
+    }
+    ::close(fd);
+
+    if (rename(tmp_path.c_str(), path.c_str()) < 0) {
+        ::unlink(tmp_path.c_str());
+        fail("rename " + tmp_path);
+    }
+
+    // rename 自体を永続化するためにディレクトリも fsync する
+    string dir = fs::path(path).parent_path().string();
+    int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        ::close(dir_fd);
+    }
+}
+
+// === OutputBuffer ===
+// 1 行ごとに flush しないよう、まとめて write(2) する
+class OutputBuffer {
+public:
+    static constexpr size_t capacity = 64 * 1024;
+
+    explicit OutputBuffer(int fd = STDOUT_FILENO) : fd_(fd) {
+        buffer_.reserve(capacity);
+    }
+
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    OutputBuffer& operator<<(string_view s) {
+        buffer_ += s;
+        if (buffer_.size() >= capacity) flush();
+        return *this;
+    }
+
+    OutputBuffer& operator<<(char c) {
+        buffer_ += c;
+        if (buffer_.size() >= capacity) flush();
+        return *this;
+    }
+
+    OutputBuffer& operator<<(size_t n) {
+        char digits[24];
+        auto [ptr, ec] = to_chars(digits, digits + sizeof(digits), n);
+        return *this << string_view(digits, static_cast<size_t>(ptr - digits));
+    }
+
+    OutputBuffer& operator<<(int n) {
+        char digits[16];
+        auto [ptr, ec] = to_chars(digits, digits + sizeof(digits), n);
+        return *this << string_view(digits, static_cast<size_t>(ptr - digits));
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < buffer_.size()) {
+            ssize_t n = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        buffer_.clear();
+    }
+
+private:
+    int fd_;
+    string buffer_;
+};
+
+// === Store ===
+// コマンドから見た保存先。TaskStore（テキスト全体を書き直す）と LogStore（追記ログ）がある
+class Store {
+public:
+    virtual ~Store() = default;
+
+    virtual vector<Task> load() = 0;
+
+    // 全タスクを順に渡す。ビューはコールバック中だけ有効
+    virtual void scan(const function<void(const TaskView&)>& fn) {
+        for (const Task& task : load()) {
+            fn(TaskView{task.id, task.description, task.done});
+        }
+    }
+
+    virtual optional<Task> find(int id) = 0;
+    virtual Task add(const string& description) = 0;
+    virtual void update(const Task& task) = 0;   // done の状態を書き込む
+    virtual void remove(int id) = 0;
+    virtual vector<Task> clear_done() = 0;       // 完了済みを削除し、削除したものを返す
+    virtual size_t size() = 0;
+
+    // 不要になった記録を詰める。対応していなければ false
+    virtual bool compact() { return false; }
+
+    // begin_batch() から commit() までの変更は、最後にまとめて 1 回だけ永続化する
+    virtual void begin_batch() {}
+    virtual void commit() {}
 };
 
 // === TaskStore ===
-class TaskStore {
+// todo.txt 形式。プロセス内では一度だけ読み、変更のたびに全体をアトミックに書き直す。
+// ID は行に書いて保存するので、削除しても他のタスクの ID は変わらない。
+// 行頭に ID を足した分、Python / Go 版の todo.txt とは形式が違う（あちらでは ID が説明の一部に見える）。
+// 古い形式の行は読めるので、向こうで書いたファイルをこちらで開くのは問題ない
+// ID → 位置の索引を持ち、find / update は線形探索しない
+class TaskStore : public Store {
 public:
     TaskStore(const string& file_path) : file_path_(file_path) {}
 
-    vector<Task> load() const {
-        vector<Task> tasks;
+    vector<Task> load() override {
+        return tasks();
+    }
 
-        if (!fs::exists(file_path_)) {
-            return tasks;
+    // まだ読み込んでいなければ mmap した上をそのまま走査する（Task を作らない）
+    void scan(const function<void(const TaskView&)>& fn) override {
+        if (loaded_) {
+            Store::scan(fn);
+            return;
         }
+        MappedFile file(file_path_);
+        int last_id = 0;
+        for_each_line(file.view(), [&](string_view line) {
+            TaskView view = TaskView::from_line(last_id + 1, line);
+            last_id = view.id;
+            fn(view);
+        });
+    }
 
-        ifstream file(file_path_);
-        string line;
-        int id = 1;
+    optional<Task> find(int id) override {
+        auto& all = tasks();
+        auto it = position_.find(id);
+        if (it == position_.end()) return nullopt;
+        return all[it->second];
+    }
+
+    Task add(const string& description) override {
+        auto& all = tasks();
+        all.push_back(Task{next_id_++, description, false});
+        position_[all.back().id] = all.size() - 1;
+        save(all);
+        return all.back();
+    }
+
+    void update(const Task& task) override {
+        auto& all = tasks();
+        auto it = position_.find(task.id);
+        if (it == position_.end()) return;
+        all[it->second].done = task.done;
+        save(all);
+    }
+
+    void remove(int id) override {
+        auto& all = tasks();
+        auto it = position_.find(id);
+        if (it == position_.end()) return;
+        all.erase(all.begin() + static_cast<ptrdiff_t>(it->second));
+        reindex();
+        save(all);
+    }
 
-        while (getline(file, line)) {
-            if (!line.empty()) {
-                tasks.push_back(Task::from_line(id++, line));
+    vector<Task> clear_done() override {
+        auto& all = tasks();
+
+        vector<Task> done_tasks;
+        vector<Task> pending_tasks;
+
+        for (auto& task : all) {
+            if (task.done) {
+                done_tasks.push_back(move(task));
+            } else {
+                pending_tasks.push_back(move(task));
             }
         }
 
+        all = move(pending_tasks);
+        if (done_tasks.empty()) return done_tasks;
+
+        reindex();
+        save(all);
+        return done_tasks;
+    }
+
+    size_t size() override {
+        return tasks().size();
+    }
+
+    void begin_batch() override {
+        batch_ = true;
+    }
+
+    void commit() override {
+        batch_ = false;
+        if (dirty_) {
+            save(tasks_);
+        }
+    }
+
+private:
+    vector<Task>& tasks() {
+        if (!loaded_) {
+            tasks_ = read_file();
+            loaded_ = true;
+            reindex();
+        }
+        return tasks_;
+    }
+
+    vector<Task> read_file() const {
+        vector<Task> tasks;
+        MappedFile file(file_path_);
+        int last_id = 0;
+
+        for_each_line(file.view(), [&](string_view line) {
+            tasks.push_back(Task::from_line(last_id + 1, line));
+            last_id = tasks.back().id;
+        });
+
         return tasks;
     }
 
-    void save(const vector<Task>& tasks) const {
-        ofstream file(file_path_);
+    void reindex() {
+        position_.clear();
+        position_.reserve(tasks_.size());
+        for (size_t i = 0; i < tasks_.size(); ++i) {
+            position_[tasks_[i].id] = i;
+            next_id_ = max(next_id_, tasks_[i].id + 1);
+        }
+    }
+
+    void save(const vector<Task>& tasks) {
+        if (batch_) {
+            dirty_ = true;
+            return;
+        }
 
+        string data;
         for (const auto& task : tasks) {
-            file << task.to_line() << "\n";
+            data += task.to_line();
+            data += '\n';
         }
+        write_file_atomically(file_path_, data);
+        dirty_ = false;
     }
 
-private:
     string file_path_;
+    vector<Task> tasks_;
+    unordered_map<int, size_t> position_;  // ID → tasks_ 内の位置
+    int next_id_ = 1;
+    bool loaded_ = false;
+    bool batch_ = false;
+    bool dirty_ = false;
+};
+
+// === LogStore ===
+// 追記専用のログと、ID ごとに固定長エントリを並べた索引ファイル (<log>.idx) で管理する。
+// 1 件の変更はログへの 1 行追記 (fdatasync) と索引 1 エントリの書き換えで済み、
+// ファイル全体は読み書きしない。ID は削除しても振り直さない。
+//
+// ログの 1 行: "A <id> <説明>" 追加 / "X <id> <説明>" 完了済みで追加 (compact が出力)
+//              "D <id>" 完了 / "U <id>" 未完了に戻す / "R <id>" 削除
+//              "N <id>" 次に使う ID (compact が先頭に出力し、削除済みの ID を再利用しない)
+//
+// 正はログの方で、索引はそこから作り直せる。索引のヘッダが覚えているログの長さと
+// 実際の長さが違えば（途中で落ちた等）、ログを再生して索引を作り直す。
+class LogStore : public Store {
+public:
+    explicit LogStore(const string& log_path)
+        : log_path_(log_path), index_path_(log_path + ".idx") {
+        index_fd_ = ::open(index_path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (index_fd_ < 0) fail("open " + index_path_);
+        // 同時に動く別プロセスとはコマンド単位で排他する
+        if (flock(index_fd_, LOCK_EX) < 0) fail("flock " + index_path_);
+        open_log();
+
+        if (pread(index_fd_, &header_, sizeof(header_), 0) != sizeof(header_) ||
+            memcmp(header_.magic, index_magic, sizeof(header_.magic)) != 0 ||
+            header_.log_size != log_file_size()) {
+            rebuild();
+        }
+    }
+
+    ~LogStore() override {
+        if (log_fd_ >= 0) ::close(log_fd_);
+        if (index_fd_ >= 0) ::close(index_fd_);  // ロックも外れる
+    }
+
+    LogStore(const LogStore&) = delete;
+    LogStore& operator=(const LogStore&) = delete;
+
+    vector<Task> load() override {
+        vector<Task> tasks;
+        for (auto& slot : replay()) {
+            if (slot) tasks.push_back(move(*slot));
+        }
+        return tasks;
+    }
+
+    optional<Task> find(int id) override {
+        if (id < 1 || static_cast<uint64_t>(id) >= header_.next_id) return nullopt;
+        Entry entry = read_entry(id);
+        if (!(entry.flags & entry_live)) return nullopt;
+
+        Task task = read_record(entry.offset);
+        task.done = entry.flags & entry_done;
+        return task;
+    }
+
+    Task add(const string& description) override {
+        Task task{static_cast<int>(header_.next_id), description, false};
+        uint64_t offset = append("A " + to_string(task.id) + " " + description + "\n");
+        ++header_.next_id;
+        ++header_.live;
+        write_entry(task.id, Entry{offset, entry_live, 0});
+        write_header();
+        return task;
+    }
+
+    void update(const Task& task) override {
+        Entry entry = read_entry(task.id);
+        append((task.done ? "D " : "U ") + to_string(task.id) + "\n");
+        entry.flags = task.done ? (entry.flags | entry_done) : (entry.flags & ~entry_done);
+        write_entry(task.id, entry);
+        write_header();
+        maybe_compact();
+    }
+
+    void remove(int id) override {
+        append("R " + to_string(id) + "\n");
+        write_entry(id, Entry{0, 0, 0});
+        --header_.live;
+        write_header();
+        maybe_compact();
+    }
+
+    vector<Task> clear_done() override {
+        vector<Entry> entries = read_entries();
+        vector<Task> done_tasks;
+        string records;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if ((entries[i].flags & entry_live) && (entries[i].flags & entry_done)) {
+                int id = static_cast<int>(i) + 1;
+                Task task = read_record(entries[i].offset);
+                task.done = true;
+                done_tasks.push_back(move(task));
+                records += "R " + to_string(id) + "\n";
+                entries[i] = Entry{0, 0, 0};
+            }
+        }
+        if (done_tasks.empty()) return done_tasks;
+
+        // まとめて 1 回の追記にする
+        append(records, done_tasks.size());
+        write_all(index_fd_, entries.data(), entries.size() * sizeof(Entry), sizeof(Header));
+        header_.live -= done_tasks.size();
+        write_header();
+        maybe_compact();
+        return done_tasks;
+    }
+
+    size_t size() override {
+        return header_.live;
+    }
+
+    // バッチ中は追記ごとの fdatasync を省き、commit() で 1 回だけ行う
+    void begin_batch() override {
+        batch_ = true;
+    }
+
+    void commit() override {
+        batch_ = false;
+        sync_log();
+    }
+
+    // 今の状態だけを書いた新しいログを作って置き換える
+    bool compact() override {
+        sync_log();
+        string data = "N " + to_string(header_.next_id) + "\n";
+        for (const Task& task : load()) {
+            data += (task.done ? "X " : "A ") + to_string(task.id) + " " + task.description + "\n";
+        }
+        write_file_atomically(log_path_, data);
+
+        ::close(log_fd_);
+        open_log();
+        rebuild();
+        return true;
+    }
+
+private:
+    static constexpr char index_magic[8] = {'T', 'O', 'D', 'O', 'I', 'D', 'X', '1'};
+    static constexpr uint32_t entry_live = 1;
+    static constexpr uint32_t entry_done = 2;
+
+    // 索引ファイル: Header の後に ID 1, 2, ... の Entry が並ぶ
+    struct Header {
+        char magic[8];
+        uint64_t log_size;  // この索引が反映しているログの長さ
+        uint64_t next_id;
+        uint64_t live;      // 生きているタスク数
+        uint64_t records;   // ログの行数（compact するかの判断に使う）
+    };
+
+    struct Entry {
+        uint64_t offset;    // "A"/"X" 行の位置
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    [[noreturn]] static void fail(const string& what) {
+        throw system_error(errno, generic_category(), what);
+    }
+
+    void open_log() {
+        log_fd_ = ::open(log_path_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (log_fd_ < 0) fail("open " + log_path_);
+    }
+
+    uint64_t log_file_size() const {
+        struct stat st;
+        if (fstat(log_fd_, &st) < 0) fail("stat " + log_path_);
+        return static_cast<uint64_t>(st.st_size);
+    }
+
+    static void write_all(int fd, const void* data, size_t size, off_t offset) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = pwrite(fd, p, size, offset);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail("pwrite");
+            }
+            p += n;
+            size -= static_cast<size_t>(n);
+            offset += n;
+        }
+    }
+
+    // ログ末尾に追記して永続化し、書いた位置を返す
+    uint64_t append(const string& records, size_t count = 1) {
+        uint64_t offset = header_.log_size;
+        size_t written = 0;
+        while (written < records.size()) {
+            ssize_t n = ::write(log_fd_, records.data() + written, records.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                fail("write " + log_path_);
+            }
+            written += static_cast<size_t>(n);
+        }
+        header_.log_size += records.size();
+        unsynced_ = true;
+        if (!batch_) sync_log();
+        header_.records += count;
+        return offset;
+    }
+
+    void sync_log() {
+        if (!unsynced_) return;
+        if (fdatasync(log_fd_) < 0) fail("fdatasync " + log_path_);
+        unsynced_ = false;
+    }
+
+    Entry read_entry(int id) const {
+        Entry entry{0, 0, 0};
+        off_t offset = static_cast<off_t>(sizeof(Header) + (id - 1) * sizeof(Entry));
+        if (pread(index_fd_, &entry, sizeof(entry), offset) != sizeof(entry)) return Entry{0, 0, 0};
+        return entry;
+    }
+
+    vector<Entry> read_entries() const {
+        vector<Entry> entries(header_.next_id - 1);
+        size_t bytes = entries.size() * sizeof(Entry);
+        if (bytes > 0 && pread(index_fd_, entries.data(), bytes, sizeof(Header)) != static_cast<ssize_t>(bytes)) {
+            fail("read " + index_path_);
+        }
+        return entries;
+    }
+
+    void write_entry(int id, const Entry& entry) {
+        write_all(index_fd_, &entry, sizeof(entry), static_cast<off_t>(sizeof(Header) + (id - 1) * sizeof(Entry)));
+    }
+
+    // エントリを書いてからヘッダを書く。間で落ちてもヘッダが古いので再生される
+    void write_header() {
+        write_all(index_fd_, &header_, sizeof(header_), 0);
+    }
+
+    // offset にある "A"/"X" 行を読む
+    Task read_record(uint64_t offset) const {
+        string line;
+        char buf[256];
+        while (true) {
+            ssize_t n = pread(log_fd_, buf, sizeof(buf), static_cast<off_t>(offset + line.size()));
+            if (n <= 0) break;
+            const char* nl = static_cast<const char*>(memchr(buf, '\n', static_cast<size_t>(n)));
+            line.append(buf, nl ? static_cast<size_t>(nl - buf) : static_cast<size_t>(n));
+            if (nl) break;
+        }
+        Task task{0, "", false};
+        parse_record(line, task);
+        return task;
+    }
+
+    // "K <id> [<説明>]" を分解する。種類の文字を返し、不正なら '\0'
+    static char parse_record(const string& line, Task& task) {
+        if (line.size() < 3 || line[1] != ' ') return '\0';
+        size_t id_end = line.find(' ', 2);
+        try {
+            task.id = stoi(line.substr(2, id_end - 2));
+        } catch (const exception&) {
+            return '\0';
+        }
+        task.description = id_end == string::npos ? "" : line.substr(id_end + 1);
+        task.done = line[0] == 'X';
+        return line[0];
+    }
+
+    // ログを先頭から再生して ID 順の状態を得る。末尾の書きかけの行は無視する
+    vector<optional<Task>> replay(uint64_t* complete_size = nullptr, uint64_t* next_id = nullptr) const {
+        vector<optional<Task>> slots;
+        ifstream in(log_path_, ios::binary);
+        string line;
+        uint64_t pos = 0;
+        uint64_t complete = 0;
+        uint64_t next = 1;
+        while (getline(in, line)) {
+            pos += line.size() + 1;
+            if (in.eof()) break;  // 改行で終わっていない
+            complete = pos;
+
+            Task task{0, "", false};
+            char kind = parse_record(line, task);
+            if (kind == '\0' || task.id < 1) continue;
+            if (kind == 'N') {
+                next = max<uint64_t>(next, task.id);
+                continue;
+            }
+            next = max<uint64_t>(next, static_cast<uint64_t>(task.id) + 1);
+            size_t slot = static_cast<size_t>(task.id - 1);
+            if (slots.size() <= slot) slots.resize(slot + 1);
+
+            if (kind == 'A' || kind == 'X') {
+                slots[slot] = move(task);
+            } else if (!slots[slot]) {
+                continue;
+            } else if (kind == 'D' || kind == 'U') {
+                slots[slot]->done = kind == 'D';
+            } else if (kind == 'R') {
+                slots[slot].reset();
+            }
+        }
+        if (complete_size) *complete_size = complete;
+        if (next_id) *next_id = next;
+        return slots;
+    }
+
+    // ログから索引を作り直す
+    void rebuild() {
+        uint64_t complete = 0;
+        uint64_t next_id = 1;
+        vector<optional<Task>> slots = replay(&complete, &next_id);
+        // 書きかけの行は切り捨てる
+        if (complete != log_file_size() && ftruncate(log_fd_, static_cast<off_t>(complete)) < 0) {
+            fail("truncate " + log_path_);
+        }
+
+        Header header{};
+        memcpy(header.magic, index_magic, sizeof(header.magic));
+        header.log_size = complete;
+        header.next_id = next_id;
+
+        // 各 "A"/"X" 行の位置を求めるためにもう一度先頭から読む
+        slots.resize(next_id - 1);
+        vector<Entry> entries(slots.size(), Entry{0, 0, 0});
+        ifstream in(log_path_, ios::binary);
+        string line;
+        uint64_t pos = 0;
+        while (pos < complete && getline(in, line)) {
+            uint64_t offset = pos;
+            pos += line.size() + 1;
+            ++header.records;
+            Task task{0, "", false};
+            char kind = parse_record(line, task);
+            if ((kind == 'A' || kind == 'X') && task.id >= 1) {
+                entries[task.id - 1].offset = offset;
+            }
+        }
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i]) {
+                entries[i].flags = entry_live | (slots[i]->done ? entry_done : 0);
+                ++header.live;
+            } else {
+                entries[i] = Entry{0, 0, 0};
+            }
+        }
+
+        if (ftruncate(index_fd_, 0) < 0) fail("truncate " + index_path_);
+        write_all(index_fd_, entries.data(), entries.size() * sizeof(Entry), sizeof(Header));
+        header_ = header;
+        write_header();
+    }
+
+    // 記録の大半が不要になったら自動で詰める
+    void maybe_compact() {
+        if (header_.records >= 1024 && header_.records > 4 * header_.live) {
+            compact();
+        }
+    }
+
+    string log_path_;
+    string index_path_;
+    int log_fd_ = -1;
+    int index_fd_ = -1;
+    Header header_{};
+    bool batch_ = false;
+    bool unsynced_ = false;
+};
+
+// === TaskIndex ===
+// 説明文の単語 → ID の転置索引と、状態ごとの ID 集合。
+// 検索のたびに全タスクの説明を部分一致で調べずに済む
+class TaskIndex {
+public:
+    // 英数字の並びを小文字にして単語とする
+    static vector<string> tokenize(string_view text) {
+        vector<string> words;
+        string word;
+        for (char c : text) {
+            if (isalnum(static_cast<unsigned char>(c))) {
+                word += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            } else if (!word.empty()) {
+                words.push_back(move(word));
+                word.clear();
+            }
+        }
+        if (!word.empty()) words.push_back(move(word));
+        return words;
+    }
+
+    void insert(const TaskView& task) {
+        for (const string& word : tokenize(task.description)) {
+            postings_[word].insert(task.id);
+        }
+        (task.done ? done_ : pending_).insert(task.id);
+    }
+
+    void erase(const Task& task) {
+        for (const string& word : tokenize(task.description)) {
+            auto it = postings_.find(word);
+            if (it == postings_.end()) continue;
+            it->second.erase(task.id);
+            if (it->second.empty()) postings_.erase(it);
+        }
+        done_.erase(task.id);
+        pending_.erase(task.id);
+    }
+
+    void set_done(int id, bool done) {
+        (done ? pending_ : done_).erase(id);
+        (done ? done_ : pending_).insert(id);
+    }
+
+    // 全ての単語を含み、status が指定されていればその状態のタスクの ID を昇順で返す
+    vector<int> search(const vector<string>& words, optional<bool> status) const {
+        vector<const set<int>*> lists;
+        for (const string& word : words) {
+            auto it = postings_.find(word);
+            if (it == postings_.end()) return {};
+            lists.push_back(&it->second);
+        }
+        if (status) lists.push_back(*status ? &done_ : &pending_);
+
+        vector<int> result;
+        if (lists.empty()) {
+            set_union(done_.begin(), done_.end(), pending_.begin(), pending_.end(), back_inserter(result));
+            return result;
+        }
+
+        // 一番短いリストを起点に、他のリストに含まれるかを調べる
+        sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+        for (int id : *lists[0]) {
+            if (all_of(lists.begin() + 1, lists.end(), [id](auto* l) { return l->count(id) > 0; })) {
+                result.push_back(id);
+            }
+        }
+        return result;
+    }
+
+private:
+    unordered_map<string, set<int>> postings_;
+    set<int> done_;
+    set<int> pending_;
 };
 
 // === Commands ===
 class Commands {
 public:
-    Commands(TaskStore& store, bool verbose)
+    Commands(Store& store, bool verbose)
         : store_(store), verbose_(verbose) {}
 
     void add(const string& description) {
-        auto tasks = store_.load();
-        tasks.push_back(Task{
-            static_cast<int>(tasks.size()) + 1,
-            description,
-            false
-        });
-        store_.save(tasks);
-        cout << "Added: " << description << endl;
+        Task task = store_.add(description);
+        if (index_) index_->insert(TaskView{task.id, task.description, task.done});
+        cout << "Added: " << task.description << endl;
 
         if (verbose_) {
-            cout << "  [verbose] Total tasks: " << tasks.size() << endl;
+            cout << "  [verbose] Total tasks: " << store_.size() << endl;
         }
     }
 
     void list() {
-        auto tasks = store_.load();
+        cout.flush();  // cout と直接の write が混ざらないように
+        OutputBuffer out;
+        size_t total = 0;
+        size_t done_count = 0;
+
+        store_.scan([&](const TaskView& task) {
+            if (total == 0) out << "Tasks:\n";
+            ++total;
+            if (task.done) ++done_count;
+            out << "  " << task.id << (task.done ? " [x] " : " [ ] ") << task.description << '\n';
+        });
 
-        if (tasks.empty()) {
+        if (total == 0) {
             cout << "No tasks found." << endl;
             return;
         }
 
-        cout << "Tasks:" << endl;
-        for (const auto& task : tasks) {
-            char status = task.done ? 'x' : ' ';
-            cout << "  " << task.id << " [" << status << "] " << task.description << endl;
-        }
-
         if (verbose_) {
-            int done_count = count_if(tasks.begin(), tasks.end(),
-                                       [](const Task& t) { return t.done; });
-            cout << "\n  Total: " << tasks.size()
-                 << ", Done: " << done_count
-                 << ", Pending: " << (tasks.size() - done_count) << endl;
+            out << "\n  Total: " << total
+                << ", Done: " << done_count
+                << ", Pending: " << (total - done_count) << '\n';
         }
     }
 
     void done(int id) {
-        auto tasks = store_.load();
-
-        auto it = find_if(tasks.begin(), tasks.end(),
-                          [id](const Task& t) { return t.id == id; });
+        auto task = store_.find(id);
 
-        if (it == tasks.end()) {
+        if (!task) {
             cout << "Task " << id << " not found" << endl;
             return;
         }
 
-        if (it->done) {
+        if (task->done) {
             cout << "Task " << id << " is already done" << endl;
             return;
         }
 
-        it->done = true;
-        store_.save(tasks);
-        cout << "Done: " << it->description << endl;
+        task->done = true;
+        store_.update(*task);
+        if (index_) index_->set_done(id, true);
+        cout << "Done: " << task->description << endl;
     }
 
     void undo(int id) {
-        auto tasks = store_.load();
+        auto task = store_.find(id);
 
-        auto it = find_if(tasks.begin(), tasks.end(),
-                          [id](const Task& t) { return t.id == id; });
-
-        if (it == tasks.end()) {
+        if (!task) {
             cout << "Task " << id << " not found" << endl;
             return;
         }
 
-        if (!it->done) {
+        if (!task->done) {
             cout << "Task " << id << " is not completed" << endl;
             return;
         }
 
-        it->done = false;
-        store_.save(tasks);
-        cout << "Undone: " << it->description << endl;
+        task->done = false;
+        store_.update(*task);
+        if (index_) index_->set_done(id, false);
+        cout << "Undone: " << task->description << endl;
     }
 
     void remove(int id) {
-        auto tasks = store_.load();
-
-        auto it = find_if(tasks.begin(), tasks.end(),
-                          [id](const Task& t) { return t.id == id; });
+        auto task = store_.find(id);
 
-        if (it == tasks.end()) {
+        if (!task) {
             cout << "Task " << id << " not found" << endl;
             return;
         }
 
-        string description = it->description;
-        tasks.erase(it);
-
-        // ID を振り直す
-        for (size_t i = 0; i < tasks.size(); ++i) {
-            tasks[i].id = static_cast<int>(i) + 1;
-        }
-
-        store_.save(tasks);
-        cout << "Deleted: " << description << endl;
+        store_.remove(id);
+        if (index_) index_->erase(*task);
+        cout << "Deleted: " << task->description << endl;
     }
 
     void clear() {
-        auto tasks = store_.load();
-
-        vector<Task> done_tasks;
-        vector<Task> pending_tasks;
-
-        for (const auto& task : tasks) {
-            if (task.done) {
-                done_tasks.push_back(task);
-            } else {
-                pending_tasks.push_back(task);
-            }
+        auto done_tasks = store_.clear_done();
+        if (index_) {
+            for (const auto& task : done_tasks) index_->erase(task);
         }
 
         if (done_tasks.empty()) {
@@ -206,12 +957,6 @@ public:
             return;
         }
 
-        // ID を振り直す
-        for (size_t i = 0; i < pending_tasks.size(); ++i) {
-            pending_tasks[i].id = static_cast<int>(i) + 1;
-        }
-
-        store_.save(pending_tasks);
         cout << "Cleared " << done_tasks.size() << " completed task(s)." << endl;
 
         if (verbose_) {
@@ -221,15 +966,115 @@ public:
         }
     }
 
+    // 単語はすべて含むもの (AND)。status が指定されればその状態だけ
+    void search(const vector<string>& terms, optional<bool> status) {
+        if (!index_) {
+            // 索引は最初の検索で一度だけ作り、以降の変更は増分で反映する（batch で効く）
+            index_.emplace();
+            store_.scan([this](const TaskView& task) { index_->insert(task); });
+        }
+
+        vector<string> words;
+        for (const string& term : terms) {
+            for (string& word : TaskIndex::tokenize(term)) words.push_back(move(word));
+        }
+        vector<int> ids = index_->search(words, status);
+
+        if (ids.empty()) {
+            cout << "No matching tasks." << endl;
+            return;
+        }
+
+        cout.flush();
+        OutputBuffer out;
+        out << "Found " << ids.size() << " task(s):\n";
+        for (int id : ids) {
+            auto task = store_.find(id);
+            if (!task) continue;
+            out << "  " << task->id << (task->done ? " [x] " : " [ ] ") << task->description << '\n';
+        }
+    }
+
+    void compact() {
+        if (!store_.compact()) {
+            cout << "compact is only available with --log" << endl;
+            return;
+        }
+        cout << "Compacted " << store_.size() << " task(s)." << endl;
+    }
+
 private:
-    TaskStore& store_;
+    Store& store_;
     bool verbose_;
+    optional<TaskIndex> index_;
 };
 
+// === ベンチマーク ===
+// `todo bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+// 一時ディレクトリ（TMPDIR）に 1k / 100k / 1M 件の todo.txt を作り、TaskStore の読み込みと
+// 書き直しを測る。書き直しは fsync まで含むので、ディスクの速さがそのまま出る。
+int run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("cli_tool", options);
+    fs::path dir = fs::temp_directory_path() / ("todo-bench-" + to_string(getpid()));
+    fs::create_directories(dir);
+
+    for (size_t count : {size_t{1000}, size_t{100000}, size_t{1000000}}) {
+        string label = count >= 1000000 ? to_string(count / 1000000) + "m" : to_string(count / 1000) + "k";
+        string path = (dir / ("todo-" + label + ".txt")).string();
+        // どのケースも選ばれていなければファイルも作らない
+        auto wanted = [&](const char* name) {
+            return (string(name) + "/" + label).find(options.filter) != string::npos;
+        };
+        if (!wanted("load") && !wanted("scan") && !wanted("save")) continue;
+
+        string data;
+        for (size_t i = 1; i <= count; ++i) {
+            Task task{static_cast<int>(i), "Review the deploy checklist #" + to_string(i), i % 3 == 0};
+            data += task.to_line();
+            data += '\n';
+        }
+        write_file_atomically(path, data);
+        double tasks = static_cast<double>(count);
+
+        // 新しい TaskStore で全件を Task にする（add / done などの前に必ず通る）
+        runner.run("load/" + label, tasks, "task", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TaskStore store(path);
+                bench::keep(store.load());
+            }
+        });
+
+        // mmap した上を走査するだけ（list / search の経路）
+        runner.run("scan/" + label, tasks, "task", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TaskStore store(path);
+                size_t done = 0;
+                store.scan([&](const TaskView& task) { done += task.done; });
+                bench::keep(done);
+            }
+        });
+
+        // 1 件の done を切り替えて全体を書き直す（ファイルの大きさは変わらない）
+        TaskStore store(path);
+        Task first = *store.find(1);
+        runner.run("save/" + label, tasks, "task", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                first.done = !first.done;
+                store.update(first);
+            }
+        });
+    }
+
+    fs::remove_all(dir);
+    runner.finish();
+    return 0;
+}
+
 // === CLI ===
 struct Options {
-    string file = "todo.txt";
+    string file;
     bool verbose = false;
+    bool log = false;
     string command;
     vector<string> args;
 };
@@ -248,17 +1093,28 @@ COMMANDS:
     undo <id>     Mark a task as not done
     delete <id>   Delete a task
     clear         Clear all completed tasks
+    search <words...> [--pending|--done]
+                  Find tasks whose description contains all words
+                  (alias: filter)
+    compact       Rewrite the log with only live tasks (--log only)
+    batch [file]  Run one command per line from file (or stdin)
+                  and save once at the end
+    bench [--filter <name>] [--reps <n>] [--min-ms <ms>] [--json]
+                  Measure TaskStore load/scan/save with 1k/100k/1M tasks
     help          Show this help message
 
 OPTIONS:
-    -f, --file <path>    Use a custom file (default: todo.txt)
+    -f, --file <path>    Use a custom file (default: todo.txt, or todo.log with --log)
+    -l, --log            Store tasks in an append-only log with an index
     -v, --verbose        Show verbose output
 
 EXAMPLES:
     todo add "Buy milk"
     todo list
     todo done 1
+    todo search deploy --pending
     todo list --verbose
+    printf 'add Deploy\ndone 1\n' | todo batch
 
 )" << endl;
 }
@@ -275,6 +1131,8 @@ Options parse_args(int argc, char* argv[]) {
             }
         } else if (arg == "-v" || arg == "--verbose") {
             opts.verbose = true;
+        } else if (arg == "-l" || arg == "--log") {
+            opts.log = true;
         } else if (arg == "-h" || arg == "--help") {
             opts.command = "help";
         } else if (opts.command.empty()) {
@@ -287,58 +1145,168 @@ Options parse_args(int argc, char* argv[]) {
     return opts;
 }
 
-int main(int argc, char* argv[]) {
-    Options opts = parse_args(argc, argv);
-
-    if (opts.command.empty() || opts.command == "help") {
-        print_help();
-        return 0;
-    }
+// 1 コマンドを実行する。引数の誤りなどは 1 を返す
+// タスク ID を読む。数字でないもの・int に収まらないものは nullopt
+optional<int> parse_task_id(const string& arg) {
+    int id = 0;
+    auto [ptr, ec] = from_chars(arg.data(), arg.data() + arg.size(), id);
+    if (ec != errc() || ptr != arg.data() + arg.size()) return nullopt;
+    return id;
+}
 
-    TaskStore store(opts.file);
-    Commands commands(store, opts.verbose);
+int dispatch(Commands& commands, const string& command, const vector<string>& args,
+             bool in_batch = false) {
+    auto task_id = [&]() {
+        optional<int> id = parse_task_id(args[0]);
+        if (!id) cout << "Error: invalid task ID: " << args[0] << endl;
+        return id;
+    };
 
-    if (opts.command == "add") {
-        if (opts.args.empty()) {
+    if (command == "add") {
+        if (args.empty()) {
             cout << "Error: add requires a task description" << endl;
             return 1;
         }
 
         // 引数を結合
         string description;
-        for (size_t i = 0; i < opts.args.size(); ++i) {
+        for (size_t i = 0; i < args.size(); ++i) {
             if (i > 0) description += " ";
-            description += opts.args[i];
+            description += args[i];
         }
 
         commands.add(description);
-    } else if (opts.command == "list" || opts.command == "ls") {
+    } else if (command == "list" || command == "ls") {
         commands.list();
-    } else if (opts.command == "done") {
-        if (opts.args.empty()) {
+    } else if (command == "done") {
+        if (args.empty()) {
             cout << "Error: done requires a task ID" << endl;
             return 1;
         }
-        commands.done(stoi(opts.args[0]));
-    } else if (opts.command == "undo") {
-        if (opts.args.empty()) {
+        optional<int> id = task_id();
+        if (!id) return 1;
+        commands.done(*id);
+    } else if (command == "undo") {
+        if (args.empty()) {
             cout << "Error: undo requires a task ID" << endl;
             return 1;
         }
-        commands.undo(stoi(opts.args[0]));
-    } else if (opts.command == "delete" || opts.command == "rm") {
-        if (opts.args.empty()) {
+        optional<int> id = task_id();
+        if (!id) return 1;
+        commands.undo(*id);
+    } else if (command == "delete" || command == "rm") {
+        if (args.empty()) {
             cout << "Error: delete requires a task ID" << endl;
             return 1;
         }
-        commands.remove(stoi(opts.args[0]));
-    } else if (opts.command == "clear") {
+        optional<int> id = task_id();
+        if (!id) return 1;
+        commands.remove(*id);
+    } else if (command == "clear") {
         commands.clear();
+    } else if (command == "search" || command == "filter") {
+        vector<string> terms;
+        optional<bool> status;
+        for (const string& arg : args) {
+            if (arg == "--pending") {
+                status = false;
+            } else if (arg == "--done") {
+                status = true;
+            } else {
+                terms.push_back(arg);
+            }
+        }
+        if (terms.empty() && !status) {
+            cout << "Error: search requires words, --pending or --done" << endl;
+            return 1;
+        }
+        commands.search(terms, status);
+    } else if (command == "compact") {
+        commands.compact();
     } else {
-        cout << "Unknown command: " << opts.command << endl;
-        print_help();
+        cout << "Unknown command: " << command << endl;
+        if (!in_batch) print_help();
         return 1;
     }
 
     return 0;
 }
+
+// 1 行 1 コマンドで読み、同じ Store に対して順に実行してから 1 回だけ commit する。
+// 空行と '#' で始まる行は無視。失敗した行があっても残りは続け、終了コードを 1 にする
+int run_batch(Store& store, Commands& commands, istream& in) {
+    int status = 0;
+    size_t line_number = 0;
+    string line;
+
+    store.begin_batch();
+    while (getline(in, line)) {
+        ++line_number;
+        istringstream words(line);
+        string command;
+        if (!(words >> command) || command[0] == '#') continue;
+        if (command == "batch") {
+            cout << "Error: line " << line_number << ": batch cannot be nested" << endl;
+            status = 1;
+            continue;
+        }
+
+        vector<string> args;
+        for (string word; words >> word;) args.push_back(word);
+
+        // 例外もその行だけの失敗とし、ループを抜けずに最後の commit まで進む
+        try {
+            if (dispatch(commands, command, args, true) != 0) status = 1;
+        } catch (const exception& e) {
+            cout << "Error: line " << line_number << ": " << e.what() << endl;
+            status = 1;
+        }
+    }
+    store.commit();
+    return status;
+}
+
+int run_command(const Options& opts) {
+    unique_ptr<Store> store;
+    if (opts.log) {
+        store = make_unique<LogStore>(opts.file);
+    } else {
+        store = make_unique<TaskStore>(opts.file);
+    }
+    Commands commands(*store, opts.verbose);
+
+    if (opts.command == "batch") {
+        if (opts.args.empty() || opts.args[0] == "-") {
+            return run_batch(*store, commands, cin);
+        }
+        ifstream in(opts.args[0]);
+        if (!in) {
+            cout << "Error: cannot open " << opts.args[0] << endl;
+            return 1;
+        }
+        return run_batch(*store, commands, in);
+    }
+
+    return dispatch(commands, opts.command, opts.args);
+}
+
+int main(int argc, char* argv[]) {
+    Options opts = parse_args(argc, argv);
+
+    if (opts.command.empty() || opts.command == "help") {
+        print_help();
+        return 0;
+    }
+
+    if (opts.file.empty()) {
+        opts.file = opts.log ? "todo.log" : "todo.txt";
+    }
+
+    try {
+        if (opts.command == "bench") return run_benchmarks(bench::parse_options(opts.args));
+        return run_command(opts);
+    } catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
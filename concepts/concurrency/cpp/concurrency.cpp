@@ -4,6 +4,10 @@
 // thread, mutex, future, atomic など。
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
@@ -14,6 +18,24 @@
 #include <queue>
 #include <chrono>
 #include <functional>
+#include <deque>
+#include <memory>
+#include <type_traits>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+#include <cmath>
+#include <utility>
+#include <optional>
+#include <new>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 using namespace chrono;
@@ -385,6 +407,871 @@ void thread_pool_demo() {
     cout << endl;
 }
 
+// === ロックフリーキュー ===
+// mutex + queue の受け渡しは、混むとロック待ちの行列 (convoy) ができて遅延の裾が伸びる。
+// どちらも容量固定 (2 のべき乗) で、確保は構築時の 1 回だけ。
+// 生産者側と消費者側の位置は別々のキャッシュラインに置き、偽共有を避ける。
+constexpr size_t cache_line = 64;
+constexpr int spin_limit = 128;
+
+// ブロッキング版の待ち合わせ。待っているスレッドがいなければ notify() は waiters_ を読むだけで、
+// 共有の epoch_ には書かない（try_push / try_pop の速い経路に競合する RMW を足さない）。
+// 待つ側は waiters_ で名乗ってから状態を確かめ直し、通知側は状態を変えてから waiters_ を見る。
+// 間の seq_cst フェンスで、どちらか一方は必ず相手の書き込みを見る（取りこぼさない）。
+// 1 つずつ別のキャッシュラインに置く
+class alignas(cache_line) Notifier {
+public:
+    // ready() が偽（false や空の optional）のあいだ眠って待ち、真になった値を返す
+    template<typename F>
+    auto wait_until(F ready) {
+        while (true) {
+            waiters_.fetch_add(1);
+            atomic_thread_fence(memory_order_seq_cst);
+            uint32_t seen = epoch_.load();
+            auto result = ready();
+            if (result) {
+                waiters_.fetch_sub(1);
+                return result;
+            }
+            epoch_.wait(seen);
+            waiters_.fetch_sub(1);
+        }
+    }
+
+    void notify() {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiters_.load(memory_order_relaxed) == 0) return;
+        epoch_.fetch_add(1);
+        epoch_.notify_all();
+    }
+
+private:
+    atomic<uint32_t> epoch_{0};
+    atomic<uint32_t> waiters_{0};
+};
+
+// Vyukov の有界 MPMC キュー。各セルの sequence が「このセルは何周目の push / pop を待っているか」
+// を表すので、生産者・消費者は位置の CAS 1 回でセルを確保できる
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask_(bit_ceil(max<size_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    ~MpmcQueue() {
+        while (try_pop()) {}
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 満杯なら false（value はそのまま残る）
+    bool try_push(T& value) {
+        size_t pos = enqueue_pos_.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(move(value));
+        cell->sequence.store(pos + 1, memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    bool try_push(T&& value) { return try_push(value); }
+
+    // 空なら nullopt
+    optional<T> try_pop() {
+        size_t pos = dequeue_pos_.load(memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return nullopt;
+            } else {
+                pos = dequeue_pos_.load(memory_order_relaxed);
+            }
+        }
+        T* item = cell->item();
+        optional<T> result(move(*item));
+        item->~T();
+        cell->sequence.store(pos + mask_ + 1, memory_order_release);
+        not_full_.notify();
+        return result;
+    }
+
+    // ブロッキング版: 空き / 要素ができるまで待つ。眠る前に少しだけスピンする
+    void push(T value) {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (try_push(value)) return;
+        }
+        not_full_.wait_until([&] { return try_push(value); });
+    }
+
+    T pop() {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (auto item = try_pop()) return move(*item);
+        }
+        return move(*not_empty_.wait_until([&] { return try_pop(); }));
+    }
+
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* item() { return launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    const size_t mask_;
+    unique_ptr<Cell[]> cells_;
+    alignas(cache_line) atomic<size_t> enqueue_pos_{0};
+    alignas(cache_line) atomic<size_t> dequeue_pos_{0};
+    Notifier not_empty_;
+    Notifier not_full_;
+};
+
+// 生産者 1・消費者 1 専用のリングバッファ。CAS が要らず、load / store だけで済む。
+// 相手側の位置はキャッシュしておき、満杯 / 空に見えたときだけ読み直す
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(bit_ceil(max<size_t>(capacity, 2)) - 1), slots_(new Slot[mask_ + 1]) {}
+
+    ~SpscRing() {
+        while (try_pop()) {}
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    bool try_push(T& value) {
+        size_t tail = tail_.load(memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(memory_order_acquire);
+            if (tail - cached_head_ > mask_) return false;
+        }
+        new (slots_[tail & mask_].storage) T(move(value));
+        tail_.store(tail + 1, memory_order_release);
+        not_empty_.notify();
+        return true;
+    }
+
+    bool try_push(T&& value) { return try_push(value); }
+
+    optional<T> try_pop() {
+        size_t head = head_.load(memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(memory_order_acquire);
+            if (head == cached_tail_) return nullopt;
+        }
+        T* item = slots_[head & mask_].item();
+        optional<T> result(move(*item));
+        item->~T();
+        head_.store(head + 1, memory_order_release);
+        not_full_.notify();
+        return result;
+    }
+
+    void push(T value) {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (try_push(value)) return;
+        }
+        not_full_.wait_until([&] { return try_push(value); });
+    }
+
+    T pop() {
+        for (int spin = 0; spin < spin_limit; ++spin) {
+            if (auto item = try_pop()) return move(*item);
+        }
+        return move(*not_empty_.wait_until([&] { return try_pop(); }));
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* item() { return launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    const size_t mask_;
+    unique_ptr<Slot[]> slots_;
+    alignas(cache_line) atomic<size_t> tail_{0};  // 生産者が書く
+    size_t cached_head_ = 0;
+    alignas(cache_line) atomic<size_t> head_{0};  // 消費者が書く
+    size_t cached_tail_ = 0;
+    Notifier not_empty_;
+    Notifier not_full_;
+};
+
+void lockfree_queue_demo() {
+    cout << "=== ロックフリーキュー ===" << endl;
+
+    // 非ブロッキング版は満杯 / 空をその場で返す
+    MpmcQueue<int> small(4);
+    int pushed = 0;
+    while (small.try_push(pushed)) ++pushed;
+    cout << "  MpmcQueue(4) accepted " << pushed << " items before full" << endl;
+    cout << "  try_pop: " << *small.try_pop() << ", ";
+    while (small.try_pop()) {}
+    cout << "empty: " << (small.try_pop() ? "no" : "yes") << endl;
+
+    // SPSC: condition_variable_demo と同じ生産者 / 消費者をロックなしで
+    constexpr int items = 200000;
+    {
+        SpscRing<int> ring(1024);
+        long long sum = 0;
+        auto start = steady_clock::now();
+        thread producer([&ring]() {
+            for (int i = 1; i <= items; ++i) ring.push(i);
+        });
+        for (int i = 0; i < items; ++i) sum += ring.pop();
+        producer.join();
+        auto us = duration_cast<microseconds>(steady_clock::now() - start).count();
+        cout << "  SpscRing: " << items << " items, sum=" << sum << " (" << us << " us)" << endl;
+    }
+
+    // MPMC: 生産者 4・消費者 4
+    {
+        MpmcQueue<int> queue(1024);
+        atomic<long long> sum{0};
+        constexpr int producers = 4;
+        constexpr int per_producer = items / producers;
+        auto start = steady_clock::now();
+        vector<thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue]() {
+                for (int i = 1; i <= per_producer; ++i) queue.push(i);
+            });
+            threads.emplace_back([&queue, &sum]() {
+                long long local = 0;
+                for (int i = 0; i < per_producer; ++i) local += queue.pop();
+                sum.fetch_add(local);
+            });
+        }
+        for (auto& t : threads) t.join();
+        auto us = duration_cast<microseconds>(steady_clock::now() - start).count();
+        cout << "  MpmcQueue: " << producers << "x" << per_producer << " items, sum=" << sum.load()
+             << " (" << us << " us)" << endl;
+    }
+
+    cout << endl;
+}
+
+// === ワークスティーリング・スレッドプール ===
+// ワーカーごとに Chase-Lev デック（ロックフリー）を持つ。
+// - ワーカー内から投入したタスクは自分のデックの底に積み、底から取る (LIFO: キャッシュに温かい)
+// - 暇なワーカーは他のデックの天井から盗む (FIFO: 大きな塊から持っていく)
+// - ワーカー外からの投入だけは共有の注入キュー (MpmcQueue) を通る
+// 1 つの mutex に全タスクが集まらないので、細かいタスクでもスケールする。
+
+// 型消去したタスク。packaged_task と function の二重確保をせず、1 回の new で済ませる
+struct Job {
+    virtual ~Job() = default;
+    virtual void run() = 0;
+};
+
+template<typename F>
+struct JobImpl : Job {
+    explicit JobImpl(F&& f) : fn(move(f)) {}
+    void run() override { fn(); }
+    F fn;
+};
+
+// Chase-Lev デック (Lê et al. 2013 の弱いメモリモデル向け版)。
+// push / pop は持ち主のワーカーだけ、steal はどのスレッドからでも呼べる
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256)
+        : array_(new Array(capacity)) {}
+
+    ~WorkStealingDeque() {
+        delete array_.load(memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    void push(Job* job) {
+        int64_t b = bottom_.load(memory_order_relaxed);
+        int64_t t = top_.load(memory_order_acquire);
+        Array* a = array_.load(memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, job);
+        bottom_.store(b + 1, memory_order_release);
+    }
+
+    Job* pop() {
+        int64_t b = bottom_.load(memory_order_relaxed) - 1;
+        Array* a = array_.load(memory_order_relaxed);
+        bottom_.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t t = top_.load(memory_order_relaxed);
+
+        if (t > b) {  // 空
+            bottom_.store(b + 1, memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = a->get(b);
+        if (t == b) {
+            // 最後の 1 個は泥棒と取り合いになる
+            if (!top_.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom_.store(b + 1, memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* steal() {
+        int64_t t = top_.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t b = bottom_.load(memory_order_acquire);
+        if (t >= b) return nullptr;
+
+        Array* a = array_.load(memory_order_acquire);
+        Job* job = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            return nullptr;  // 他の泥棒か持ち主に取られた
+        }
+        return job;
+    }
+
+    bool empty() const {
+        return bottom_.load(memory_order_relaxed) <= top_.load(memory_order_relaxed);
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t cap)
+            : capacity(cap), mask(cap - 1), slots(new atomic<Job*>[static_cast<size_t>(cap)]) {}
+
+        Job* get(int64_t i) const { return slots[static_cast<size_t>(i & mask)].load(memory_order_relaxed); }
+        void put(int64_t i, Job* job) { slots[static_cast<size_t>(i & mask)].store(job, memory_order_relaxed); }
+
+        int64_t capacity;
+        int64_t mask;
+        unique_ptr<atomic<Job*>[]> slots;
+    };
+
+    // 満杯になったら 2 倍の配列に移す。泥棒が古い配列を読んでいるかもしれないので
+    // 古い配列はデックが破棄されるまで残しておく
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        Array* bigger = new Array(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+        retired_.emplace_back(old);
+        array_.store(bigger, memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) atomic<int64_t> top_{0};
+    alignas(64) atomic<int64_t> bottom_{0};
+    alignas(64) atomic<Array*> array_;
+    vector<unique_ptr<Array>> retired_;
+};
+
+class WorkStealingPool {
+public:
+    // pin_threads = true ならワーカー i を CPU (i % コア数) に固定する (Linux のみ)
+    explicit WorkStealingPool(size_t num_threads = thread::hardware_concurrency(), bool pin_threads = false) {
+        num_threads = max<size_t>(num_threads, 1);
+        for (size_t i = 0; i < num_threads; ++i) {
+            queues_.push_back(make_unique<WorkStealingDeque>());
+        }
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this, i, pin_threads]() {
+                if (pin_threads) pin_to_cpu(i);
+                worker_loop(i);
+            });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(sleep_mtx_);
+            stop_ = true;
+        }
+        epoch_.fetch_add(1);
+        sleep_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t size() const { return workers_.size(); }
+
+    // 任意の呼び出し可能オブジェクトを投入し、戻り値の future を返す
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> future<invoke_result_t<decay_t<F>, decay_t<Args>...>> {
+        using R = invoke_result_t<decay_t<F>, decay_t<Args>...>;
+        packaged_task<R()> task(
+            [fn = forward<F>(f), ... captured = forward<Args>(args)]() mutable {
+                return invoke(move(fn), move(captured)...);
+            });
+        future<R> result = task.get_future();
+        Job* job = new JobImpl<packaged_task<R()>>(move(task));
+        schedule(&job, 1);
+        return result;
+    }
+
+    // f(0) ... f(count - 1) をまとめて投入する。ワーカーを起こすのは 1 回だけ
+    template<typename F>
+    auto submit_bulk(size_t count, F f) -> vector<future<invoke_result_t<F&, size_t>>> {
+        using R = invoke_result_t<F&, size_t>;
+        vector<future<R>> results;
+        vector<Job*> jobs;
+        results.reserve(count);
+        jobs.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            packaged_task<R()> task([f, i]() mutable { return f(i); });
+            results.push_back(task.get_future());
+            jobs.push_back(new JobImpl<packaged_task<R()>>(move(task)));
+        }
+        schedule(jobs.data(), jobs.size());
+        return results;
+    }
+
+    // done() が真になるまで待つ。ワーカー内から呼ばれたときは眠らずに他のタスクを片付けながら待つので、
+    // タスクの中でさらに並列処理を待っても全ワーカーが待ち状態で詰まることがない
+    template<typename Pred>
+    void wait_until(Pred done) {
+        if (current_.pool == this) {
+            while (!done()) {
+                if (Job* job = find_job(current_.index)) {
+                    run(job);
+                } else {
+                    this_thread::yield();
+                }
+            }
+            return;
+        }
+        completed_.wait_until([&] { return done(); });
+    }
+
+private:
+    friend class TaskGroup;
+
+    // 今のスレッドがこのプールのワーカーなら、その番号
+    // thread_local なのでゼロ初期化される
+    struct WorkerContext {
+        WorkStealingPool* pool;
+        size_t index;
+        uint32_t seed;  // 盗む相手を選ぶ xorshift の状態
+    };
+    static inline thread_local WorkerContext current_{};
+
+    static void pin_to_cpu(size_t index) {
+#ifdef __linux__
+        unsigned cpus = max(1u, thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)index;
+#endif
+    }
+
+    void schedule(Job** jobs, size_t count) {
+        if (current_.pool == this) {
+            // ワーカー内からは自分のデックへ（ロックなし）
+            WorkStealingDeque& local = *queues_[current_.index];
+            for (size_t i = 0; i < count; ++i) local.push(jobs[i]);
+        } else {
+            size_t i = 0;
+            while (i < count && injected_.try_push(jobs[i])) ++i;
+            if (i < count) {
+                // 注入キューが満杯のときだけロック付きのあふれ用キューへ
+                lock_guard<mutex> lock(overflow_mtx_);
+                overflow_.insert(overflow_.end(), jobs + i, jobs + count);
+                overflow_count_.fetch_add(count - i, memory_order_release);
+            }
+        }
+        wake(count);
+    }
+
+    // 寝ているワーカーを起こす。epoch を進めてから sleepers_ を見るので、
+    // 寝る直前のワーカーも epoch の変化に気づいて寝ずに済む
+    void wake(size_t count) {
+        epoch_.fetch_add(1);
+        if (sleepers_.load() == 0) return;
+        {
+            lock_guard<mutex> lock(sleep_mtx_);
+        }
+        if (count == 1) {
+            sleep_cv_.notify_one();
+        } else {
+            sleep_cv_.notify_all();
+        }
+    }
+
+    Job* take_injected() {
+        if (auto job = injected_.try_pop()) return *job;
+        if (overflow_count_.load(memory_order_acquire) == 0) return nullptr;
+        lock_guard<mutex> lock(overflow_mtx_);
+        if (overflow_.empty()) return nullptr;
+        Job* job = overflow_.front();
+        overflow_.pop_front();
+        overflow_count_.fetch_sub(1, memory_order_relaxed);
+        return job;
+    }
+
+    // 自分のデック → 注入キュー → 他のワーカーから盗む、の順に探す
+    Job* find_job(size_t index) {
+        if (Job* job = queues_[index]->pop()) return job;
+        if (Job* job = take_injected()) return job;
+
+        uint32_t& seed = current_.seed;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        size_t n = queues_.size();
+        size_t start = seed % n;
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == index) continue;
+            if (Job* job = queues_[victim]->steal()) return job;
+        }
+        return nullptr;
+    }
+
+    void worker_loop(size_t index) {
+        current_ = {this, index, static_cast<uint32_t>(index + 1)};
+
+        while (true) {
+            if (Job* job = find_job(index)) {
+                run(job);
+                continue;
+            }
+
+            uint64_t epoch = epoch_.load();
+            // epoch を読んだ後にもう一度探す。これ以降の投入は epoch の変化でわかる
+            if (Job* job = find_job(index)) {
+                run(job);
+                continue;
+            }
+
+            unique_lock<mutex> lock(sleep_mtx_);
+            if (stop_) return;
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [&]() { return stop_ || epoch_.load() != epoch; });
+            sleepers_.fetch_sub(1);
+        }
+    }
+
+    static void run(Job* job) {
+        job->run();  // packaged_task が例外を future に移すので、ここでは投げない
+        delete job;
+    }
+
+    vector<unique_ptr<WorkStealingDeque>> queues_;
+    vector<thread> workers_;
+
+    MpmcQueue<Job*> injected_{1024};
+    mutex overflow_mtx_;
+    deque<Job*> overflow_;
+    atomic<size_t> overflow_count_{0};
+
+    mutex sleep_mtx_;
+    condition_variable sleep_cv_;
+    atomic<uint64_t> epoch_{0};
+    atomic<size_t> sleepers_{0};
+    bool stop_ = false;
+
+    Notifier completed_;  // ワーカー外で wait_until しているスレッドを起こす
+};
+
+void work_stealing_demo() {
+    cout << "=== ワークスティーリング・スレッドプール ===" << endl;
+
+    WorkStealingPool pool(4);
+
+    // 戻り値のある任意の呼び出し
+    future<int> sum = pool.submit([](int a, int b) { return a + b; }, 2, 3);
+    future<string> text = pool.submit([]() { return string("typed future"); });
+    cout << "  submit: 2 + 3 = " << sum.get() << ", " << text.get() << endl;
+
+    // 例外も future に伝わる
+    future<void> failing = pool.submit([]() { throw runtime_error("task failed"); });
+    try {
+        failing.get();
+    } catch (const exception& e) {
+        cout << "  Caught exception: " << e.what() << endl;
+    }
+
+    // まとめて投入（ワーカーを起こすのは 1 回）
+    auto squares = pool.submit_bulk(8, [](size_t i) { return i * i; });
+    cout << "  submit_bulk squares:";
+    for (auto& f : squares) cout << " " << f.get();
+    cout << endl;
+
+    // タスクの中から投入した子タスクは自分のデックに積まれ、暇なワーカーに盗まれる
+    atomic<int> leaves{0};
+    pool.submit([&pool, &leaves]() {
+        for (int i = 0; i < 1000; ++i) {
+            pool.submit([&leaves]() { leaves.fetch_add(1, memory_order_relaxed); });
+        }
+    }).get();
+    while (leaves.load() < 1000) this_thread::yield();
+    cout << "  Nested tasks completed: " << leaves.load() << endl;
+
+    // 細かいタスクを大量に流したときの比較
+    constexpr size_t tiny_tasks = 100000;
+    atomic<size_t> counter{0};
+    auto tiny = [&counter](size_t) { counter.fetch_add(1, memory_order_relaxed); };
+
+    auto start = steady_clock::now();
+    {
+        ThreadPool simple(4);
+        vector<future<void>> futures;
+        futures.reserve(tiny_tasks);
+        for (size_t i = 0; i < tiny_tasks; ++i) {
+            futures.push_back(simple.enqueue([&tiny, i]() { tiny(i); }));
+        }
+        for (auto& f : futures) f.get();
+    }
+    auto simple_ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    for (auto& f : pool.submit_bulk(tiny_tasks, tiny)) f.get();
+    auto stealing_ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+    cout << "  " << tiny_tasks << " tiny tasks: ThreadPool " << simple_ms
+         << " ms, WorkStealingPool " << stealing_ms << " ms (counter " << counter.load() << ")" << endl;
+
+    cout << endl;
+}
+
+// === 並列アルゴリズム ===
+// TaskGroup: 投入したタスクが全部終わるのを待つ入れ物。wait() は WorkStealingPool::wait_until を使うので、
+// ワーカー内から入れ子で使っても安全
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool_(pool) {}
+
+    ~TaskGroup() {
+        pool_.wait_until([this]() { return pending_.load(memory_order_acquire) == 0; });
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template<typename F>
+    void run(F&& f) {
+        pending_.fetch_add(1, memory_order_relaxed);
+        auto task = [this, pool = &pool_, fn = forward<F>(f)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                lock_guard<mutex> lock(error_mtx_);
+                if (!error_) error_ = current_exception();
+            }
+            // 0 になった瞬間に wait() が戻って this が消えうるので、以降は pool しか触らない
+            if (pending_.fetch_sub(1, memory_order_acq_rel) == 1) {
+                pool->completed_.notify();
+            }
+        };
+        Job* job = new JobImpl<decltype(task)>(move(task));
+        pool_.schedule(&job, 1);
+    }
+
+    // 全タスクの完了を待ち、最初に投げられた例外があれば再送出する
+    void wait() {
+        pool_.wait_until([this]() { return pending_.load(memory_order_acquire) == 0; });
+        if (error_) rethrow_exception(exchange(error_, nullptr));
+    }
+
+private:
+    WorkStealingPool& pool_;
+    atomic<size_t> pending_{0};
+    mutex error_mtx_;
+    exception_ptr error_;
+};
+
+// grain = 0 ならワーカー数の 8 倍程度の塊に分ける
+inline size_t default_grain(const WorkStealingPool& pool, size_t n) {
+    return max<size_t>(n / (pool.size() * 8), 1);
+}
+
+// [begin, end) を半分ずつに割り、右半分をタスクとして自分のデックに積んで左半分を続ける。
+// 暇なワーカーは古い（大きい）右半分から盗むので、負荷の偏りに合わせて分割が進む
+template<typename Body>
+void split_range(TaskGroup& group, size_t begin, size_t end, size_t grain, const Body& body) {
+    while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        group.run([&group, mid, end, grain, &body]() { split_range(group, mid, end, grain, body); });
+        end = mid;
+    }
+    body(begin, end);
+}
+
+// body(begin, end) を塊ごとに呼ぶ
+template<typename Body>
+void parallel_for_chunks(WorkStealingPool& pool, size_t n, size_t grain, const Body& body) {
+    if (n == 0) return;
+    if (grain == 0) grain = default_grain(pool, n);
+    TaskGroup group(pool);
+    split_range(group, 0, n, grain, body);
+    group.wait();
+}
+
+// f(i) for i in [begin, end)
+template<typename F>
+    requires invocable<F&, size_t>
+void parallel_for(WorkStealingPool& pool, size_t begin, size_t end, F f, size_t grain = 0) {
+    if (end <= begin) return;
+    parallel_for_chunks(pool, end - begin, grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) f(begin + i);
+    });
+}
+
+// f(要素) を range の全要素に。vector もビュー (iota | transform など) も受け付ける
+template<ranges::random_access_range R, typename F>
+    requires ranges::sized_range<R>
+void parallel_for(WorkStealingPool& pool, R&& range, F f, size_t grain = 0) {
+    auto first = ranges::begin(range);
+    parallel_for_chunks(pool, static_cast<size_t>(ranges::size(range)), grain, [&](size_t b, size_t e) {
+        for (auto it = first + b, last = first + e; it != last; ++it) f(*it);
+    });
+}
+
+// reduce(init, 各要素の transform) を並列に計算する。
+// 塊ごとの部分和を塊の順に畳むので、reduce は結合的であれば可換でなくてよい
+template<ranges::random_access_range R, typename T, typename Reduce, typename Transform = identity>
+    requires ranges::sized_range<R>
+T parallel_reduce(WorkStealingPool& pool, R&& range, T init, Reduce reduce,
+                  Transform transform = {}, size_t grain = 0) {
+    size_t n = static_cast<size_t>(ranges::size(range));
+    if (n == 0) return init;
+    if (grain == 0) grain = default_grain(pool, n);
+
+    auto first = ranges::begin(range);
+    size_t chunks = (n + grain - 1) / grain;
+    vector<optional<T>> partial(chunks);
+    parallel_for(pool, 0, chunks, [&](size_t c) {
+        auto it = first + c * grain;
+        auto last = first + min(n, (c + 1) * grain);
+        T acc = static_cast<T>(invoke(transform, *it));
+        for (++it; it != last; ++it) acc = reduce(move(acc), invoke(transform, *it));
+        partial[c] = move(acc);
+    }, 1);
+
+    for (auto& p : partial) init = reduce(move(init), move(*p));
+    return init;
+}
+
+// 並列マージソート。左右を並列にソートしてから inplace_merge する（安定ではない）
+template<random_access_iterator It, typename Comp>
+void parallel_sort_impl(WorkStealingPool& pool, It first, It last, Comp& comp, size_t grain) {
+    auto n = static_cast<size_t>(last - first);
+    if (n <= grain) {
+        sort(first, last, comp);
+        return;
+    }
+    It mid = first + static_cast<ptrdiff_t>(n / 2);
+    {
+        TaskGroup group(pool);
+        group.run([&]() { parallel_sort_impl(pool, first, mid, comp, grain); });
+        parallel_sort_impl(pool, mid, last, comp, grain);
+        group.wait();
+    }
+    inplace_merge(first, mid, last, comp);
+}
+
+template<ranges::random_access_range R, typename Comp = ranges::less>
+    requires sortable<ranges::iterator_t<R>, Comp>
+void parallel_sort(WorkStealingPool& pool, R&& range, Comp comp = {}, size_t grain = 0) {
+    size_t n = static_cast<size_t>(ranges::distance(range));
+    if (grain == 0) grain = max<size_t>(default_grain(pool, n), 2048);
+    parallel_sort_impl(pool, ranges::begin(range), ranges::end(range), comp, grain);
+}
+
+void parallel_algorithms_demo() {
+    cout << "=== 並列アルゴリズム ===" << endl;
+
+    WorkStealingPool pool(4);
+    constexpr size_t n = 1'000'000;
+
+    // 手で塊に分けなくても、インデックスや要素ごとの処理を書くだけでよい
+    vector<double> values(n);
+    parallel_for(pool, 0, n, [&values](size_t i) { values[i] = sqrt(static_cast<double>(i)); });
+    parallel_for(pool, values, [](double& v) { v *= 2.0; });
+    cout << "  parallel_for: values[10000] = " << values[10000] << endl;
+
+    // ranges のパイプラインをそのまま渡せる
+    auto squares = views::iota(size_t{0}, n) | views::transform([](size_t x) { return x * x; });
+    auto sum = parallel_reduce(pool, squares, size_t{0}, plus<>{});
+    cout << "  parallel_reduce(iota | transform): sum of squares = " << sum << endl;
+
+    auto max_value = parallel_reduce(pool, values, 0.0, [](double a, double b) { return max(a, b); });
+    cout << "  parallel_reduce(max): " << max_value << endl;
+
+    // 結合的だが可換でない演算（文字列連結）も順序どおりになる
+    vector<string> words = {"work", "-", "stealing", " ", "reduce"};
+    auto joined = parallel_reduce(pool, words, string(), plus<>{}, identity{}, 1);
+    cout << "  parallel_reduce(concat): " << joined << endl;
+
+    vector<int> data(n);
+    uint32_t x = 12345;
+    for (auto& d : data) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        d = static_cast<int>(x % 1000000);
+    }
+    auto start = steady_clock::now();
+    parallel_sort(pool, data);
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    cout << "  parallel_sort: " << n << " ints, sorted=" << boolalpha << ranges::is_sorted(data)
+         << " (" << ms << " ms)" << endl;
+
+    // 入れ子: タスクの中でさらに parallel_for を待ってもデッドロックしない
+    WorkStealingPool small(2);
+    atomic<size_t> inner{0};
+    parallel_for(small, 0, 16, [&](size_t) {
+        parallel_for(small, 0, 1000, [&](size_t) { inner.fetch_add(1, memory_order_relaxed); }, 10);
+    }, 1);
+    cout << "  Nested parallel_for on 2 workers: " << inner.load() << " inner iterations" << endl;
+
+    // 例外は呼び出し元に届く
+    try {
+        parallel_for(pool, 0, 100, [](size_t i) {
+            if (i == 42) throw runtime_error("failed at 42");
+        });
+    } catch (const exception& e) {
+        cout << "  Caught exception: " << e.what() << endl;
+    }
+
+    cout << endl;
+}
+
 // === call_once ===
 void call_once_demo() {
     cout << "=== call_once ===" << endl;
@@ -411,7 +1298,135 @@ void call_once_demo() {
     cout << endl;
 }
 
-int main() {
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("concurrency", options);
+    size_t threads = max(2u, thread::hardware_concurrency());
+
+    // 空のタスクを n 個投入して全部終わるまで。投入・取り出し・起床のコストだけが出る
+    {
+        ThreadPool pool(threads);
+        runner.run("enqueue/ThreadPool", 1, "task", [&](uint64_t n) {
+            atomic<uint64_t> done{0};
+            for (uint64_t i = 0; i < n; ++i) {
+                pool.enqueue([&done] { done.fetch_add(1, memory_order_relaxed); });
+            }
+            while (done.load() < n) this_thread::yield();
+        });
+    }
+
+    WorkStealingPool ws(threads);
+    runner.run("submit/WorkStealingPool", 1, "task", [&](uint64_t n) {
+        atomic<uint64_t> done{0};
+        for (uint64_t i = 0; i < n; ++i) {
+            ws.submit([&done] { done.fetch_add(1, memory_order_relaxed); });
+        }
+        while (done.load() < n) this_thread::yield();
+    });
+    runner.run("submit_bulk/WorkStealingPool", 1, "task", [&](uint64_t n) {
+        auto futures = ws.submit_bulk(n, [](size_t i) { bench::keep(i); });
+        for (auto& f : futures) f.wait();
+    });
+    runner.run("task_group/WorkStealingPool", 1, "task", [&](uint64_t n) {
+        atomic<uint64_t> done{0};
+        TaskGroup group(ws);
+        for (uint64_t i = 0; i < n; ++i) {
+            group.run([&done] { done.fetch_add(1, memory_order_relaxed); });
+        }
+        group.wait();
+    });
+
+    // 競合のない 1 スレッドでの push + pop
+    MpmcQueue<uint64_t> mpmc(1024);
+    SpscRing<uint64_t> spsc(1024);
+    runner.run("push_pop/MpmcQueue", 1, "op", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            mpmc.try_push(i);
+            bench::keep(mpmc.try_pop());
+        }
+    });
+    runner.run("push_pop/SpscRing", 1, "op", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            spsc.try_push(i);
+            bench::keep(spsc.try_pop());
+        }
+    });
+
+    // 生産者 1・消費者 1 のスレッド間受け渡し
+    runner.run("transfer/MpmcQueue", 1, "item", [&](uint64_t n) {
+        thread consumer([&] {
+            for (uint64_t i = 0; i < n; ++i) bench::keep(mpmc.pop());
+        });
+        for (uint64_t i = 0; i < n; ++i) mpmc.push(i);
+        consumer.join();
+    });
+    runner.run("transfer/SpscRing", 1, "item", [&](uint64_t n) {
+        thread consumer([&] {
+            for (uint64_t got = 0; got < n;) {
+                if (auto v = spsc.try_pop()) {
+                    bench::keep(*v);
+                    ++got;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+        for (uint64_t i = 0; i < n; ++i) {
+            while (!spsc.try_push(i)) this_thread::yield();
+        }
+        consumer.join();
+    });
+
+    // 並列アルゴリズムと逐次版
+    constexpr size_t n_elems = size_t{1} << 20;
+    vector<double> values(n_elems);
+    runner.run("for/serial/1M", n_elems, "elem", [&](uint64_t n) {
+        for (uint64_t r = 0; r < n; ++r) {
+            for (size_t i = 0; i < n_elems; ++i) values[i] = sqrt(static_cast<double>(i + r));
+            bench::keep(values);
+        }
+    });
+    runner.run("for/parallel/1M", n_elems, "elem", [&](uint64_t n) {
+        for (uint64_t r = 0; r < n; ++r) {
+            parallel_for(ws, 0, n_elems, [&](size_t i) { values[i] = sqrt(static_cast<double>(i + r)); });
+            bench::keep(values);
+        }
+    });
+
+    vector<uint32_t> shuffled(n_elems);
+    uint32_t x = 2463534242u;
+    for (auto& v : shuffled) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        v = x;
+    }
+    vector<uint32_t> work;
+    runner.run("sort/std::sort/1M", n_elems, "elem", [&](uint64_t n) {
+        for (uint64_t r = 0; r < n; ++r) {
+            work = shuffled;
+            sort(work.begin(), work.end());
+            bench::keep(work);
+        }
+    });
+    runner.run("sort/parallel_sort/1M", n_elems, "elem", [&](uint64_t n) {
+        for (uint64_t r = 0; r < n; ++r) {
+            work = shuffled;
+            parallel_sort(ws, work);
+            bench::keep(work);
+        }
+    });
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        return 0;
+    }
+
     cout << "=== Concurrency Demo ===" << endl << endl;
 
     basic_thread();
@@ -423,6 +1438,9 @@ int main() {
     promise_demo();
     atomic_demo();
     thread_pool_demo();
+    lockfree_queue_demo();
+    work_stealing_demo();
+    parallel_algorithms_demo();
     call_once_demo();
 
     return 0;
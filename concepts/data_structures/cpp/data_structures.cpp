@@ -4,6 +4,9 @@
 // vector, list, deque, map, set, unordered_map など。
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
 #include <vector>
 #include <array>
 #include <list>
@@ -18,6 +21,16 @@
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <ranges>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 
@@ -391,6 +404,8 @@ void custom_linked_list_demo() {
 }
 
 // === 二分探索木 ===
+// 平衡化しないので、整列済みの入力では高さ N の一本道になる（操作が O(N)）。
+// 再帰すると一本道の木でスタックを使い切るので、操作はすべてループで書く。
 template<typename T>
 class BST {
 public:
@@ -401,44 +416,57 @@ public:
         Node(const T& v) : value(v), left(nullptr), right(nullptr) {}
     };
 
+    BST() = default;
+
+    // unique_ptr の連鎖に任せると深さぶん再帰するので、明示的なスタックで外す
+    ~BST() {
+        vector<unique_ptr<Node>> stack;
+        if (root_) stack.push_back(move(root_));
+        while (!stack.empty()) {
+            unique_ptr<Node> node = move(stack.back());
+            stack.pop_back();
+            if (node->left) stack.push_back(move(node->left));
+            if (node->right) stack.push_back(move(node->right));
+        }
+    }
+
+    BST(BST&&) noexcept = default;
+    BST& operator=(BST&&) noexcept = default;
+
     void insert(const T& value) {
-        insert_impl(root_, value);
+        unique_ptr<Node>* slot = &root_;
+        while (*slot) {
+            slot = value < (*slot)->value ? &(*slot)->left : &(*slot)->right;
+        }
+        *slot = make_unique<Node>(value);
     }
 
     bool search(const T& value) const {
-        return search_impl(root_.get(), value);
+        const Node* node = root_.get();
+        while (node) {
+            if (value == node->value) return true;
+            node = value < node->value ? node->left.get() : node->right.get();
+        }
+        return false;
     }
 
     void inorder(vector<T>& result) const {
-        inorder_impl(root_.get(), result);
+        vector<const Node*> stack;
+        const Node* node = root_.get();
+        while (node || !stack.empty()) {
+            while (node) {
+                stack.push_back(node);
+                node = node->left.get();
+            }
+            node = stack.back();
+            stack.pop_back();
+            result.push_back(node->value);
+            node = node->right.get();
+        }
     }
 
 private:
     unique_ptr<Node> root_;
-
-    void insert_impl(unique_ptr<Node>& node, const T& value) {
-        if (!node) {
-            node = make_unique<Node>(value);
-        } else if (value < node->value) {
-            insert_impl(node->left, value);
-        } else {
-            insert_impl(node->right, value);
-        }
-    }
-
-    bool search_impl(const Node* node, const T& value) const {
-        if (!node) return false;
-        if (value == node->value) return true;
-        if (value < node->value) return search_impl(node->left.get(), value);
-        return search_impl(node->right.get(), value);
-    }
-
-    void inorder_impl(const Node* node, vector<T>& result) const {
-        if (!node) return;
-        inorder_impl(node->left.get(), result);
-        result.push_back(node->value);
-        inorder_impl(node->right.get(), result);
-    }
 };
 
 void bst_demo() {
@@ -461,7 +489,694 @@ void bst_demo() {
     cout << endl;
 }
 
-int main() {
+// === B+ 木 ===
+// 節点を数キャッシュライン（既定 256 バイト）に収めた順序付き索引。
+// - 分岐数が大きいので木が浅く、100 万キーでも 5 段程度。1 段につきキャッシュミスは数回で済む
+// - 節点内のキーは配列に詰めて置く。数値キーは「key より小さいキーの個数」を分岐なしで数えて
+//   位置を求める（比較結果を足すだけのループ）
+// - 値は葉だけに置き、葉を next でつなぐので範囲走査は葉を順に読むだけ
+// - 操作はすべて反復。根からの経路は固定長の配列に積む
+// Key は operator< で比較し、既定構築・ムーブできること
+template<typename Key, typename Value, size_t NodeBytes = 256>
+class BPlusTree {
+    static constexpr size_t header_bytes = 16;
+
+public:
+    static constexpr size_t leaf_slots =
+        max<size_t>(4, (NodeBytes - header_bytes - sizeof(void*)) / (sizeof(Key) + sizeof(Value)));
+    static constexpr size_t inner_slots =
+        max<size_t>(4, (NodeBytes - header_bytes - sizeof(void*)) / (sizeof(Key) + sizeof(void*)));
+
+private:
+    // 分割で作られる節点はこれ以上の要素を持つ。削除でこれを下回ったら兄弟から借りるか併合する
+    static constexpr size_t leaf_min = leaf_slots / 2;
+    static constexpr size_t inner_min = (inner_slots - 1) / 2;
+    static constexpr size_t max_depth = 64;
+
+    struct Node {
+        uint32_t count = 0;  // 葉: 要素数 / 内部節点: キー数（子は count + 1 個）
+        bool leaf;
+        explicit Node(bool is_leaf) : leaf(is_leaf) {}
+    };
+
+    struct alignas(64) Leaf : Node {
+        Key keys[leaf_slots]{};
+        Value values[leaf_slots]{};
+        Leaf* next = nullptr;
+        Leaf() : Node(true) {}
+    };
+
+    // keys[i] は children[i + 1] の部分木の最小キー以下で、children[i] の全キーより大きい
+    struct alignas(64) Inner : Node {
+        Key keys[inner_slots]{};
+        Node* children[inner_slots + 1];
+        Inner() : Node(false) {}
+    };
+
+public:
+    class ConstIterator {
+    public:
+        using iterator_category = forward_iterator_tag;
+        using value_type = pair<const Key, Value>;
+        using difference_type = ptrdiff_t;
+
+        ConstIterator(const Leaf* leaf = nullptr, uint32_t index = 0) : leaf_(leaf), index_(index) {}
+
+        const Key& key() const { return leaf_->keys[index_]; }
+        const Value& value() const { return leaf_->values[index_]; }
+        pair<const Key&, const Value&> operator*() const { return {key(), value()}; }
+
+        ConstIterator& operator++() {
+            if (++index_ == leaf_->count) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return leaf_ == other.leaf_ && index_ == other.index_;
+        }
+        bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+
+    private:
+        const Leaf* leaf_;
+        uint32_t index_;
+    };
+
+    BPlusTree() = default;
+    ~BPlusTree() { clear(); }
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    BPlusTree(BPlusTree&& other) noexcept
+        : root_(exchange(other.root_, nullptr)),
+          size_(exchange(other.size_, 0)),
+          height_(exchange(other.height_, 0)) {}
+
+    BPlusTree& operator=(BPlusTree&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root_ = exchange(other.root_, nullptr);
+            size_ = exchange(other.size_, 0);
+            height_ = exchange(other.height_, 0);
+        }
+        return *this;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t height() const { return height_; }
+
+    const Value* find(const Key& key) const {
+        const Leaf* leaf = find_leaf(key);
+        if (!leaf) return nullptr;
+        size_t i = count_less(leaf->keys, leaf->count, key);
+        return i < leaf->count && !(key < leaf->keys[i]) ? &leaf->values[i] : nullptr;
+    }
+
+    Value* find(const Key& key) {
+        return const_cast<Value*>(static_cast<const BPlusTree&>(*this).find(key));
+    }
+
+    bool contains(const Key& key) const { return find(key) != nullptr; }
+
+    // 追加する。既にあるキーなら何もせず false
+    bool insert(const Key& key, Value value) {
+        if (!root_) {
+            auto* leaf = new Leaf;
+            leaf->keys[0] = key;
+            leaf->values[0] = move(value);
+            leaf->count = 1;
+            root_ = leaf;
+            size_ = height_ = 1;
+            return true;
+        }
+
+        Inner* path[max_depth];
+        size_t slots[max_depth];
+        size_t depth = 0;
+        Leaf* leaf = descend(key, path, slots, depth);
+
+        size_t pos = count_less(leaf->keys, leaf->count, key);
+        if (pos < leaf->count && !(key < leaf->keys[pos])) return false;
+        ++size_;
+
+        if (leaf->count < leaf_slots) {
+            insert_into_leaf(leaf, pos, key, move(value));
+            return true;
+        }
+
+        // 葉を分割し、右の葉の先頭キーを区切りとして親へ。親があふれたら根に向かって繰り返す
+        auto [separator, child] = split_leaf(leaf, pos, key, move(value));
+        while (depth > 0) {
+            --depth;
+            Inner* parent = path[depth];
+            if (parent->count < inner_slots) {
+                insert_into_inner(parent, slots[depth], move(separator), child);
+                return true;
+            }
+            tie(separator, child) = split_inner(parent, slots[depth], move(separator), child);
+        }
+
+        auto* root = new Inner;
+        root->keys[0] = move(separator);
+        root->children[0] = root_;
+        root->children[1] = child;
+        root->count = 1;
+        root_ = root;
+        ++height_;
+        return true;
+    }
+
+    // 削除する。なければ false
+    bool erase(const Key& key) {
+        if (!root_) return false;
+
+        Inner* path[max_depth];
+        size_t slots[max_depth];
+        size_t depth = 0;
+        Leaf* leaf = descend(key, path, slots, depth);
+
+        size_t pos = count_less(leaf->keys, leaf->count, key);
+        if (pos == leaf->count || key < leaf->keys[pos]) return false;
+
+        move(leaf->keys + pos + 1, leaf->keys + leaf->count, leaf->keys + pos);
+        move(leaf->values + pos + 1, leaf->values + leaf->count, leaf->values + pos);
+        --leaf->count;
+        release_slot(leaf->keys[leaf->count], leaf->values[leaf->count]);
+        --size_;
+
+        // 要素が少なくなりすぎた節点を、兄弟から借りるか併合して直す。併合で親が減れば親も直す
+        Node* node = leaf;
+        while (depth > 0 && node->count < (node->leaf ? leaf_min : inner_min)) {
+            --depth;
+            rebalance(path[depth], slots[depth]);
+            node = path[depth];
+        }
+
+        if (root_->count == 0) {
+            if (root_->leaf) {
+                delete static_cast<Leaf*>(root_);
+                root_ = nullptr;
+                height_ = 0;
+            } else {
+                auto* old = static_cast<Inner*>(root_);
+                root_ = old->children[0];
+                delete old;
+                --height_;
+            }
+        }
+        return true;
+    }
+
+    // 昇順・重複なしの (key, value) 列から一括構築する。葉を満杯に詰めてから上の段を作るので、
+    // 1 件ずつ insert するより分割がなく速い
+    template<ranges::input_range R>
+    void bulk_load(R&& sorted) {
+        clear();
+        vector<Node*> level;
+        vector<Key> firsts;  // level の各節点の部分木の最小キー
+        Leaf* leaf = nullptr;
+
+        for (auto&& [key, value] : sorted) {
+            if (leaf && !(leaf->keys[leaf->count - 1] < key)) {
+                for (Node* n : level) delete static_cast<Leaf*>(n);
+                size_ = 0;
+                throw invalid_argument("bulk_load: keys must be strictly increasing");
+            }
+            if (!leaf || leaf->count == leaf_slots) {
+                auto* fresh = new Leaf;
+                if (leaf) leaf->next = fresh;
+                leaf = fresh;
+                level.push_back(fresh);
+            }
+            leaf->keys[leaf->count] = key;
+            leaf->values[leaf->count] = value;
+            ++leaf->count;
+            ++size_;
+        }
+        if (level.empty()) return;
+
+        // 最後の葉が少なすぎれば左隣から分けてもらう
+        if (level.size() > 1 && leaf->count < leaf_min) {
+            auto* before = static_cast<Leaf*>(level[level.size() - 2]);
+            size_t need = leaf_min - leaf->count;
+            move_backward(leaf->keys, leaf->keys + leaf->count, leaf->keys + leaf->count + need);
+            move_backward(leaf->values, leaf->values + leaf->count, leaf->values + leaf->count + need);
+            move(before->keys + before->count - need, before->keys + before->count, leaf->keys);
+            move(before->values + before->count - need, before->values + before->count, leaf->values);
+            before->count -= static_cast<uint32_t>(need);
+            leaf->count += static_cast<uint32_t>(need);
+        }
+        for (Node* n : level) firsts.push_back(static_cast<Leaf*>(n)->keys[0]);
+        height_ = 1;
+
+        // 上の段: 子を節点数で均等に割り、各子の最小キーを区切りにする
+        while (level.size() > 1) {
+            size_t n = level.size();
+            size_t nodes = (n + inner_slots) / (inner_slots + 1);
+            vector<Node*> parents;
+            vector<Key> parent_firsts;
+            size_t i = 0;
+            for (size_t j = 0; j < nodes; ++j) {
+                size_t take = n / nodes + (j < n % nodes ? 1 : 0);
+                auto* inner = new Inner;
+                inner->children[0] = level[i];
+                for (size_t k = 1; k < take; ++k) {
+                    inner->keys[k - 1] = firsts[i + k];
+                    inner->children[k] = level[i + k];
+                }
+                inner->count = static_cast<uint32_t>(take - 1);
+                parents.push_back(inner);
+                parent_firsts.push_back(firsts[i]);
+                i += take;
+            }
+            level = move(parents);
+            firsts = move(parent_firsts);
+            ++height_;
+        }
+        root_ = level[0];
+    }
+
+    // [lo, hi) のキーについて f(key, value) を昇順に呼ぶ
+    template<typename F>
+    void scan(const Key& lo, const Key& hi, F f) const {
+        for (auto it = lower_bound(lo); it != end() && it.key() < hi; ++it) {
+            f(it.key(), it.value());
+        }
+    }
+
+    ConstIterator begin() const {
+        const Node* node = root_;
+        if (!node) return end();
+        while (!node->leaf) node = static_cast<const Inner*>(node)->children[0];
+        return ConstIterator(static_cast<const Leaf*>(node), 0);
+    }
+
+    ConstIterator end() const { return ConstIterator(); }
+
+    // key 以上の最初の要素
+    ConstIterator lower_bound(const Key& key) const {
+        const Leaf* leaf = find_leaf(key);
+        if (!leaf) return end();
+        size_t i = count_less(leaf->keys, leaf->count, key);
+        if (i == leaf->count) return ConstIterator(leaf->next, 0);
+        return ConstIterator(leaf, static_cast<uint32_t>(i));
+    }
+
+    void clear() {
+        vector<Node*> stack;
+        if (root_) stack.push_back(root_);
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            if (node->leaf) {
+                delete static_cast<Leaf*>(node);
+            } else {
+                auto* inner = static_cast<Inner*>(node);
+                stack.insert(stack.end(), inner->children, inner->children + inner->count + 1);
+                delete inner;
+            }
+        }
+        root_ = nullptr;
+        size_ = height_ = 0;
+    }
+
+private:
+    // key より小さいキーの個数 (= lower_bound の位置)。
+    // 数値キーは節点の全スロットを固定回数で比べ、使用中の範囲だけ数える。
+    // 回数が定数で分岐もないので、ループはベクトル化できる（gcc なら -O3、clang は -O2 から）
+    template<size_t Slots>
+    static size_t count_less(const Key (&keys)[Slots], size_t n, const Key& key) {
+        if constexpr (is_arithmetic_v<Key>) {
+            uint32_t pos = 0;
+            for (size_t i = 0; i < Slots; ++i) pos += (i < n) & (keys[i] < key);
+            return pos;
+        } else {
+            return static_cast<size_t>(std::lower_bound(keys, keys + n, key) - keys);
+        }
+    }
+
+    // key 以下のキーの個数 (= 進むべき子の番号)
+    template<size_t Slots>
+    static size_t count_less_equal(const Key (&keys)[Slots], size_t n, const Key& key) {
+        if constexpr (is_arithmetic_v<Key>) {
+            uint32_t pos = 0;
+            for (size_t i = 0; i < Slots; ++i) pos += (i < n) & !(key < keys[i]);
+            return pos;
+        } else {
+            return static_cast<size_t>(upper_bound(keys, keys + n, key) - keys);
+        }
+    }
+
+    const Leaf* find_leaf(const Key& key) const {
+        const Node* node = root_;
+        if (!node) return nullptr;
+        while (!node->leaf) {
+            auto* inner = static_cast<const Inner*>(node);
+            node = inner->children[count_less_equal(inner->keys, inner->count, key)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    // 根から key の葉まで降り、通った内部節点と子の番号を path / slots に積む
+    Leaf* descend(const Key& key, Inner** path, size_t* slots, size_t& depth) {
+        Node* node = root_;
+        while (!node->leaf) {
+            auto* inner = static_cast<Inner*>(node);
+            size_t c = count_less_equal(inner->keys, inner->count, key);
+            path[depth] = inner;
+            slots[depth] = c;
+            ++depth;
+            node = inner->children[c];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // 空いたスロットに残った値を手放す（string などの資源をすぐ返す）
+    static void release_slot(Key& key, Value& value) {
+        if constexpr (!is_trivially_destructible_v<Key>) key = Key();
+        if constexpr (!is_trivially_destructible_v<Value>) value = Value();
+    }
+
+    static void insert_into_leaf(Leaf* leaf, size_t pos, const Key& key, Value value) {
+        move_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        move_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[pos] = key;
+        leaf->values[pos] = move(value);
+        ++leaf->count;
+    }
+
+    // keys[pos] に key、children[pos + 1] に child を入れる
+    static void insert_into_inner(Inner* inner, size_t pos, Key key, Node* child) {
+        move_backward(inner->keys + pos, inner->keys + inner->count, inner->keys + inner->count + 1);
+        move_backward(inner->children + pos + 1, inner->children + inner->count + 1,
+                      inner->children + inner->count + 2);
+        inner->keys[pos] = move(key);
+        inner->children[pos + 1] = child;
+        ++inner->count;
+    }
+
+    // 満杯の葉に (key, value) を加えて 2 つに割る。左が ceil、右が floor((slots + 1) / 2) 個
+    static pair<Key, Node*> split_leaf(Leaf* leaf, size_t pos, const Key& key, Value value) {
+        constexpr size_t left_count = leaf_slots + 1 - (leaf_slots + 1) / 2;
+        auto* right = new Leaf;
+        if (pos < left_count) {
+            size_t from = left_count - 1;
+            move(leaf->keys + from, leaf->keys + leaf_slots, right->keys);
+            move(leaf->values + from, leaf->values + leaf_slots, right->values);
+            right->count = static_cast<uint32_t>(leaf_slots - from);
+            leaf->count = static_cast<uint32_t>(from);
+            insert_into_leaf(leaf, pos, key, move(value));
+        } else {
+            move(leaf->keys + left_count, leaf->keys + leaf_slots, right->keys);
+            move(leaf->values + left_count, leaf->values + leaf_slots, right->values);
+            right->count = static_cast<uint32_t>(leaf_slots - left_count);
+            leaf->count = static_cast<uint32_t>(left_count);
+            insert_into_leaf(right, pos - left_count, key, move(value));
+        }
+        for (size_t i = leaf->count; i < leaf_slots; ++i) release_slot(leaf->keys[i], leaf->values[i]);
+        right->next = leaf->next;
+        leaf->next = right;
+        return {right->keys[0], right};
+    }
+
+    // 満杯の内部節点に (key, child) を加えて割り、真ん中のキーを親へ上げる
+    static pair<Key, Node*> split_inner(Inner* inner, size_t pos, Key key, Node* child) {
+        Key keys[inner_slots + 1];
+        Node* children[inner_slots + 2];
+        move(inner->keys, inner->keys + pos, keys);
+        keys[pos] = move(key);
+        move(inner->keys + pos, inner->keys + inner_slots, keys + pos + 1);
+        copy(inner->children, inner->children + pos + 1, children);
+        children[pos + 1] = child;
+        copy(inner->children + pos + 1, inner->children + inner_slots + 1, children + pos + 2);
+
+        constexpr size_t mid = (inner_slots + 1) / 2;
+        auto* right = new Inner;
+        move(keys, keys + mid, inner->keys);
+        copy(children, children + mid + 1, inner->children);
+        inner->count = mid;
+        move(keys + mid + 1, keys + inner_slots + 1, right->keys);
+        copy(children + mid + 1, children + inner_slots + 2, right->children);
+        right->count = static_cast<uint32_t>(inner_slots - mid);
+        for (size_t i = mid; i < inner_slots; ++i) {
+            if constexpr (!is_trivially_destructible_v<Key>) inner->keys[i] = Key();
+        }
+        return {move(keys[mid]), right};
+    }
+
+    // parent の keys[i] と children[i + 1] を取り除く
+    static void remove_from_inner(Inner* parent, size_t i) {
+        move(parent->keys + i + 1, parent->keys + parent->count, parent->keys + i);
+        move(parent->children + i + 2, parent->children + parent->count + 1, parent->children + i + 1);
+        --parent->count;
+        if constexpr (!is_trivially_destructible_v<Key>) parent->keys[parent->count] = Key();
+    }
+
+    // parent の子 c が少なくなりすぎたので、隣の兄弟と併合するか 1 つ借りる
+    void rebalance(Inner* parent, size_t c) {
+        size_t li = c > 0 ? c - 1 : c;  // (li, li + 1) を対にする
+        Node* left_node = parent->children[li];
+        Node* right_node = parent->children[li + 1];
+
+        if (left_node->leaf) {
+            auto* left = static_cast<Leaf*>(left_node);
+            auto* right = static_cast<Leaf*>(right_node);
+            if (left->count + right->count <= leaf_slots) {
+                move(right->keys, right->keys + right->count, left->keys + left->count);
+                move(right->values, right->values + right->count, left->values + left->count);
+                left->count += right->count;
+                left->next = right->next;
+                delete right;
+                remove_from_inner(parent, li);
+            } else if (left->count < right->count) {
+                left->keys[left->count] = move(right->keys[0]);
+                left->values[left->count] = move(right->values[0]);
+                ++left->count;
+                move(right->keys + 1, right->keys + right->count, right->keys);
+                move(right->values + 1, right->values + right->count, right->values);
+                --right->count;
+                release_slot(right->keys[right->count], right->values[right->count]);
+                parent->keys[li] = right->keys[0];
+            } else {
+                move_backward(right->keys, right->keys + right->count, right->keys + right->count + 1);
+                move_backward(right->values, right->values + right->count, right->values + right->count + 1);
+                --left->count;
+                right->keys[0] = move(left->keys[left->count]);
+                right->values[0] = move(left->values[left->count]);
+                ++right->count;
+                release_slot(left->keys[left->count], left->values[left->count]);
+                parent->keys[li] = right->keys[0];
+            }
+            return;
+        }
+
+        auto* left = static_cast<Inner*>(left_node);
+        auto* right = static_cast<Inner*>(right_node);
+        if (left->count + right->count + 1 <= inner_slots) {
+            // 親の区切りキーを挟んで 1 つにまとめる
+            left->keys[left->count] = move(parent->keys[li]);
+            move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+            copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+            left->count += right->count + 1;
+            delete right;
+            remove_from_inner(parent, li);
+        } else if (left->count < right->count) {
+            // 右から 1 つ回す（親のキーを経由する）
+            left->keys[left->count] = move(parent->keys[li]);
+            left->children[left->count + 1] = right->children[0];
+            ++left->count;
+            parent->keys[li] = move(right->keys[0]);
+            move(right->keys + 1, right->keys + right->count, right->keys);
+            copy(right->children + 1, right->children + right->count + 1, right->children);
+            --right->count;
+        } else {
+            move_backward(right->keys, right->keys + right->count, right->keys + right->count + 1);
+            move_backward(right->children, right->children + right->count + 1,
+                          right->children + right->count + 2);
+            right->keys[0] = move(parent->keys[li]);
+            right->children[0] = left->children[left->count];
+            ++right->count;
+            --left->count;
+            parent->keys[li] = move(left->keys[left->count]);
+        }
+    }
+
+    Node* root_ = nullptr;
+    size_t size_ = 0;
+    size_t height_ = 0;
+};
+
+void bplus_tree_demo() {
+    cout << "=== B+ 木 ===" << endl;
+    using namespace chrono;
+    auto elapsed_ms = [](auto start) {
+        return duration_cast<milliseconds>(steady_clock::now() - start).count();
+    };
+
+    // 整列済みの挿入でも高さは対数のまま（BST なら一本道になる）
+    using Tree = BPlusTree<int64_t, int64_t>;
+    cout << "  node slots: leaf " << Tree::leaf_slots << ", inner " << Tree::inner_slots << endl;
+    constexpr int64_t n = 1'000'000;
+
+    auto start = steady_clock::now();
+    Tree sorted_insert;
+    for (int64_t i = 0; i < n; ++i) sorted_insert.insert(i, i * 10);
+    cout << "  insert " << n << " sorted keys: " << elapsed_ms(start) << " ms, height "
+         << sorted_insert.height() << endl;
+
+    start = steady_clock::now();
+    BST<int> degenerate;
+    for (int i = 0; i < 10000; ++i) degenerate.insert(i);
+    cout << "  BST with 10000 sorted keys (height 10000): " << elapsed_ms(start) << " ms" << endl;
+
+    // 一括構築
+    start = steady_clock::now();
+    Tree bulk;
+    bulk.bulk_load(views::iota(int64_t{0}, n) | views::transform([](int64_t k) {
+        return pair<int64_t, int64_t>(k * 2, k);
+    }));
+    cout << "  bulk_load " << n << " keys: " << elapsed_ms(start) << " ms, height " << bulk.height() << endl;
+
+    // ランダムな検索を std::map と比べる
+    map<int64_t, int64_t> reference;
+    for (int64_t i = 0; i < n; ++i) reference.emplace(i * 2, i);
+    mt19937_64 rng(42);
+    vector<int64_t> probes(n);
+    for (auto& p : probes) p = static_cast<int64_t>(rng() % (2 * n));
+
+    int64_t hits = 0;
+    start = steady_clock::now();
+    for (int64_t key : probes) hits += reference.count(key);
+    auto map_ms = elapsed_ms(start);
+    start = steady_clock::now();
+    for (int64_t key : probes) hits -= bulk.contains(key);
+    auto tree_ms = elapsed_ms(start);
+    cout << "  " << n << " random lookups: std::map " << map_ms << " ms, BPlusTree " << tree_ms
+         << " ms (results " << (hits == 0 ? "match" : "differ") << ")" << endl;
+
+    // 範囲走査
+    int64_t sum = 0;
+    size_t count = 0;
+    bulk.scan(1000, 2000, [&](int64_t, int64_t value) { sum += value; ++count; });
+    cout << "  scan [1000, 2000): " << count << " keys, sum of values " << sum << endl;
+
+    // 削除: 半分消しても整列順と高さが保たれる
+    for (int64_t i = 0; i < n; i += 2) bulk.erase(i * 2);
+    cout << "  after erasing half: size " << bulk.size() << ", height " << bulk.height()
+         << ", first key " << bulk.begin().key() << endl;
+
+    cout << endl;
+}
+
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+// 順序付き索引 (BPlusTree / std::map) とハッシュ表をランダムなキーで比べる。
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("data_structures", options);
+    constexpr size_t n = 100'000;
+
+    mt19937_64 rng(1);
+    vector<int64_t> keys(n);
+    for (auto& k : keys) k = static_cast<int64_t>(rng() >> 1);
+    vector<int64_t> sorted_keys = keys;
+    sort(sorted_keys.begin(), sorted_keys.end());
+    sorted_keys.erase(unique(sorted_keys.begin(), sorted_keys.end()), sorted_keys.end());
+    vector<int64_t> probes(keys);
+    shuffle(probes.begin(), probes.end(), rng);
+
+    runner.run("insert/BPlusTree/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            BPlusTree<int64_t, int64_t> tree;
+            for (int64_t k : keys) tree.insert(k, k);
+            bench::keep(tree);
+        }
+    });
+    runner.run("insert/std::map/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            map<int64_t, int64_t> tree;
+            for (int64_t k : keys) tree.emplace(k, k);
+            bench::keep(tree);
+        }
+    });
+    runner.run("insert/std::unordered_map/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            unordered_map<int64_t, int64_t> table;
+            for (int64_t k : keys) table.emplace(k, k);
+            bench::keep(table);
+        }
+    });
+    runner.run("bulk_load/BPlusTree/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            BPlusTree<int64_t, int64_t> tree;
+            tree.bulk_load(sorted_keys | views::transform([](int64_t k) { return pair(k, k); }));
+            bench::keep(tree);
+        }
+    });
+
+    BPlusTree<int64_t, int64_t> tree;
+    map<int64_t, int64_t> ordered;
+    unordered_map<int64_t, int64_t> hashed;
+    for (int64_t k : keys) {
+        tree.insert(k, k);
+        ordered.emplace(k, k);
+        hashed.emplace(k, k);
+    }
+
+    runner.run("find/BPlusTree/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            int64_t sum = 0;
+            for (int64_t k : probes) sum += *tree.find(k);
+            bench::keep(sum);
+        }
+    });
+    runner.run("find/std::map/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            int64_t sum = 0;
+            for (int64_t k : probes) sum += ordered.find(k)->second;
+            bench::keep(sum);
+        }
+    });
+    runner.run("find/std::unordered_map/100k", n, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            int64_t sum = 0;
+            for (int64_t k : probes) sum += hashed.find(k)->second;
+            bench::keep(sum);
+        }
+    });
+
+    // 1000 件ずつの範囲走査（ハッシュ表ではできない）
+    const int64_t lo = sorted_keys[n / 2];
+    const int64_t hi = sorted_keys[n / 2 + 1000];
+    runner.run("scan/BPlusTree/1000", 1000, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            int64_t sum = 0;
+            tree.scan(lo, hi, [&](int64_t, int64_t v) { sum += v; });
+            bench::keep(sum);
+        }
+    });
+    runner.run("scan/std::map/1000", 1000, "key", [&](uint64_t iterations) {
+        for (uint64_t r = 0; r < iterations; ++r) {
+            int64_t sum = 0;
+            for (auto it = ordered.lower_bound(lo); it != ordered.end() && it->first < hi; ++it) {
+                sum += it->second;
+            }
+            bench::keep(sum);
+        }
+    });
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        return 0;
+    }
+
     cout << "=== Data Structures Demo ===" << endl << endl;
 
     vector_demo();
@@ -477,6 +1192,7 @@ int main() {
     multi_demo();
     custom_linked_list_demo();
     bst_demo();
+    bplus_tree_demo();
 
     return 0;
 }
@@ -4,9 +4,33 @@
 // 所有権とライフタイムを明示的に管理する。
 
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <string>
+#include <list>
+#include <memory_resource>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <new>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <bit>
+#include <type_traits>
+#include <initializer_list>
+#include <cassert>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../../../bench/bench.hpp"
 
 using namespace std;
 
@@ -304,6 +328,327 @@ void alignment_demo() {
     cout << endl;
 }
 
+// === SmallBuffer (SBO + アライメント + 大きな領域は mmap) ===
+// - N 要素までは内部の配列に置き、ヒープを使わない (Small Buffer Optimization)
+// - 先頭アドレスは常に Alignment の倍数（既定 64: キャッシュライン・SIMD 幅）
+// - huge_threshold 以上は mmap で確保し、madvise(MADV_HUGEPAGE) で透過的ヒュージページを頼む
+// - トリビアルコピー可能な型は mmap 領域なら mremap で伸ばす（ページの付け替えなのでコピーが起きない）。
+//   realloc は max_align_t 境界までしか保証しないので、ヒープ上で realloc するのは
+//   Alignment <= alignof(max_align_t) のときだけ。既定の 64 では新しい領域へ memcpy する
+template<typename T, size_t N = 16, size_t Alignment = 64>
+class SmallBuffer {
+    static_assert(N > 0, "inline capacity must be positive");
+    static_assert(has_single_bit(Alignment) && Alignment >= alignof(T) && Alignment <= 4096,
+                  "Alignment must be a power of two in [alignof(T), page size]");
+
+public:
+    static constexpr size_t huge_threshold = 2 << 20;  // 2 MiB (x86-64 のヒュージページ 1 枚)
+
+    SmallBuffer() = default;
+
+    explicit SmallBuffer(size_t n) { resize(n); }
+
+    SmallBuffer(initializer_list<T> items) {
+        reserve(items.size());
+        for (const T& item : items) push_back(item);
+    }
+
+    ~SmallBuffer() {
+        destroy_all();
+        release();
+    }
+
+    SmallBuffer(const SmallBuffer& other) {
+        append(other.data(), other.size());
+    }
+
+    SmallBuffer(SmallBuffer&& other) noexcept {
+        take(other);
+    }
+
+    SmallBuffer& operator=(const SmallBuffer& other) {
+        if (this != &other) {
+            clear();
+            append(other.data(), other.size());
+        }
+        return *this;
+    }
+
+    SmallBuffer& operator=(SmallBuffer&& other) noexcept {
+        if (this != &other) {
+            destroy_all();
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return kind_ == Kind::Inline; }
+    bool is_mapped() const { return kind_ == Kind::Mapped; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+    void reserve(size_t n) {
+        if (n > capacity_) grow(n);
+    }
+
+    void resize(size_t n) {
+        reserve(n);
+        for (size_t i = size_; i < n; ++i) new (data_ + i) T();
+        for (size_t i = n; i < size_; ++i) data_[i].~T();
+        size_ = n;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            // 引数が自分の要素を指していても読めるよう、伸ばす前に作っておく
+            T value(forward<Args>(args)...);
+            grow(size_ + 1);
+            return *new (data_ + size_++) T(move(value));
+        }
+        T* slot = new (data_ + size_) T(forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(move(value)); }
+
+    void append(const T* items, size_t n) {
+        less<const T*> before;
+        if (size_ + n > capacity_ && before(items, data_ + size_) && before(data_, items + n)) {
+            // 自分の要素を足すときは、伸ばして元の領域を手放す前に写しを取る
+            SmallBuffer copy;
+            copy.append(items, n);
+            reserve(size_ + n);
+            uninitialized_move(copy.begin(), copy.end(), data_ + size_);
+            size_ += n;
+            return;
+        }
+        reserve(size_ + n);
+        if constexpr (is_trivially_copyable_v<T>) {
+            if (n) memcpy(data_ + size_, items, n * sizeof(T));
+        } else {
+            uninitialized_copy(items, items + n, data_ + size_);
+        }
+        size_ += n;
+    }
+
+    void clear() {
+        destroy_all();
+        size_ = 0;
+    }
+
+    // 読み込み先として末尾の n 要素分を直接渡す (read(2) などで使う)。
+    // 書いた分だけ commit() で size に加える
+    T* prepare(size_t n) requires is_trivially_copyable_v<T> {
+        reserve(size_ + n);
+        return data_ + size_;
+    }
+
+    void commit(size_t n) requires is_trivially_copyable_v<T> { size_ += n; }
+
+    // 先頭 n 要素を捨てて残りを前に詰める
+    void consume(size_t n) requires is_trivially_copyable_v<T> {
+        n = min(n, size_);
+        if (n < size_) memmove(data_, data_ + n, (size_ - n) * sizeof(T));
+        size_ -= n;
+    }
+
+private:
+    enum class Kind : uint8_t { Inline, Heap, Mapped };
+
+    static size_t page_size() {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    static size_t round_up(size_t n, size_t unit) { return (n + unit - 1) / unit * unit; }
+
+    static T* map_pages(size_t bytes) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw bad_alloc();
+#ifdef MADV_HUGEPAGE
+        madvise(p, bytes, MADV_HUGEPAGE);  // 失敗しても通常ページで動く
+#endif
+        return static_cast<T*>(p);
+    }
+
+    static T* heap_allocate(size_t bytes) {
+        void* p = Alignment <= alignof(max_align_t)
+            ? malloc(bytes)
+            : aligned_alloc(Alignment, round_up(bytes, Alignment));
+        if (!p) throw bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    T* inline_data() { return reinterpret_cast<T*>(inline_); }
+
+    void grow(size_t min_capacity) {
+        size_t new_capacity = max(min_capacity, capacity_ * 2);
+        size_t bytes = new_capacity * sizeof(T);
+        if (bytes >= huge_threshold) {
+            bytes = round_up(bytes, page_size());
+            new_capacity = bytes / sizeof(T);
+        }
+
+        if constexpr (is_trivially_copyable_v<T>) {
+#ifdef __linux__
+            if (kind_ == Kind::Mapped) {
+                void* p = mremap(data_, capacity_ * sizeof(T), bytes, MREMAP_MAYMOVE);
+                if (p == MAP_FAILED) throw bad_alloc();
+                data_ = static_cast<T*>(p);
+                capacity_ = new_capacity;
+                return;
+            }
+#endif
+            if (kind_ == Kind::Heap && bytes < huge_threshold && Alignment <= alignof(max_align_t)) {
+                void* p = realloc(data_, bytes);
+                if (!p) throw bad_alloc();
+                data_ = static_cast<T*>(p);
+                capacity_ = new_capacity;
+                return;
+            }
+        }
+
+        Kind new_kind = bytes >= huge_threshold ? Kind::Mapped : Kind::Heap;
+        T* fresh = new_kind == Kind::Mapped ? map_pages(bytes) : heap_allocate(bytes);
+        if constexpr (is_trivially_copyable_v<T>) {
+            if (size_) memcpy(fresh, data_, size_ * sizeof(T));
+        } else {
+            uninitialized_move(data_, data_ + size_, fresh);
+            destroy_all();
+        }
+        release();
+        data_ = fresh;
+        capacity_ = new_capacity;
+        kind_ = new_kind;
+    }
+
+    // 要素のデストラクタを呼ぶ（領域はそのまま）
+    void destroy_all() {
+        if constexpr (!is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < size_; ++i) data_[i].~T();
+        }
+    }
+
+    // 領域を返して内部配列に戻す（要素は destroy_all 済みであること）
+    void release() {
+        if (kind_ == Kind::Heap) {
+            free(data_);
+        } else if (kind_ == Kind::Mapped) {
+            munmap(data_, capacity_ * sizeof(T));
+        }
+        kind_ = Kind::Inline;
+        data_ = inline_data();
+        capacity_ = N;
+    }
+
+    // other の中身を引き取る。内部配列の要素だけは 1 つずつムーブする
+    void take(SmallBuffer& other) noexcept {
+        if (other.kind_ == Kind::Inline) {
+            uninitialized_move(other.data_, other.data_ + other.size_, inline_data());
+            size_ = other.size_;
+            other.clear();
+            return;
+        }
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        kind_ = other.kind_;
+        other.data_ = other.inline_data();
+        other.size_ = 0;
+        other.capacity_ = N;
+        other.kind_ = Kind::Inline;
+    }
+
+    alignas(Alignment) unsigned char inline_[N * sizeof(T)];
+    T* data_ = inline_data();
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    Kind kind_ = Kind::Inline;
+};
+
+// バイト列用。短い文字列はヒープを使わず、長くなれば 64 バイト境界のヒープ → mmap へ移る
+using ByteBuffer = SmallBuffer<char, 256, 64>;
+
+void small_buffer_demo() {
+    cout << "=== SmallBuffer ===" << endl;
+    using namespace chrono;
+
+    auto aligned = [](const void* p) { return reinterpret_cast<uintptr_t>(p) % 64 == 0; };
+
+    SmallBuffer<int, 16> small;
+    for (int i = 0; i < 10; ++i) small.push_back(i);
+    cout << "  10 ints: inline=" << boolalpha << small.is_inline()
+         << " 64-byte aligned=" << aligned(small.data()) << endl;
+
+    for (int i = 10; i < 1000; ++i) small.push_back(i);
+    cout << "  1000 ints: inline=" << small.is_inline() << " capacity=" << small.capacity()
+         << " 64-byte aligned=" << aligned(small.data()) << endl;
+
+    // 非トリビアル型は realloc できないので要素をムーブして伸ばす
+    SmallBuffer<string, 2> names{"alpha", "beta"};
+    names.push_back("a string long enough to live on the heap");
+    SmallBuffer<string, 2> moved = move(names);
+    cout << "  SmallBuffer<string>: " << moved.size() << " items, moved-from size=" << names.size()
+         << ", last=" << moved[2].substr(0, 8) << "..." << endl;
+
+    // 自分の要素を足しても、伸長で元の領域を手放す前に読んでおく
+    SmallBuffer<int, 4, 16> self;
+    for (int i = 0; i < 4; ++i) self.push_back(i);
+    self.push_back(self[0]);
+    self.append(self.data(), self.size());
+    assert(self.size() == 10 && self[4] == 0 && self[5] == 0 && self[9] == 0);
+    SmallBuffer<string, 2> words{"one", "two"};
+    words.push_back(words[1]);
+    words.append(words.data(), words.size());
+    assert(words.size() == 6 && words[2] == "two" && words[5] == "two");
+    cout << "  Self push_back/append across growth: " << self.size() << " ints, " << words.size()
+         << " strings" << endl;
+
+    // 読み込み先を直接渡す使い方（受信バッファなど）
+    ByteBuffer in;
+    const char request[] = "GET / HTTP/1.1\r\n\r\n";
+    memcpy(in.prepare(sizeof(request) - 1), request, sizeof(request) - 1);
+    in.commit(sizeof(request) - 1);
+    in.consume(4);
+    cout << "  ByteBuffer after consume(4): \"" << string(in.data(), 1) << "...\" inline=" << in.is_inline()
+         << endl;
+
+    // 64 MiB まで 64 KiB ずつ追記: 2 MiB を超えると mmap に移り、以降は mremap で伸びる
+    constexpr size_t chunk = 64 * 1024;
+    constexpr size_t total = 64 << 20;
+    vector<char> block(chunk, 'x');
+
+    auto start = steady_clock::now();
+    {
+        vector<char> v;
+        for (size_t n = 0; n < total; n += chunk) v.insert(v.end(), block.begin(), block.end());
+    }
+    auto vector_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    ByteBuffer big;
+    for (size_t n = 0; n < total; n += chunk) big.append(block.data(), block.size());
+    auto buffer_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+    cout << "  Append 64 MiB: vector<char> " << vector_us << " us, ByteBuffer " << buffer_us
+         << " us (mapped=" << big.is_mapped() << ")" << endl;
+
+    cout << endl;
+}
+
 // === カスタムアロケータ ===
 template<typename T>
 class SimpleAllocator {
@@ -345,6 +690,432 @@ void custom_allocator_demo() {
     cout << endl;
 }
 
+// === プールアロケータとアリーナ ===
+// 汎用 malloc はあらゆるサイズ・スレッドからの要求に備えるぶん重い。
+// ノードのように同じ大きさのものを大量に確保・解放するなら、専用のアロケータで済ませる。
+// - SizeClassPool: サイズクラスごとのフリーリスト。スレッドローカルなキャッシュから取るのでロック不要
+// - MonotonicArena: ポインタを進めるだけの確保。個別の解放はせず reset() で一括して巻き戻す
+// - PoolResource / MonotonicArena / CountingResource は pmr::memory_resource なので pmr コンテナにそのまま渡せる
+
+// 確保回数のカウンタ。ベンチマークで確保が消えたかを確かめるのに使う
+struct AllocationStats {
+    atomic<size_t> allocations{0};
+    atomic<size_t> deallocations{0};
+    atomic<size_t> bytes{0};
+    atomic<size_t> upstream_allocations{0};  // 上流 (operator new など) まで行った回数
+
+    void record_allocate(size_t n) {
+        allocations.fetch_add(1, memory_order_relaxed);
+        bytes.fetch_add(n, memory_order_relaxed);
+    }
+
+    void record_deallocate() {
+        deallocations.fetch_add(1, memory_order_relaxed);
+    }
+
+    void reset() {
+        allocations = 0;
+        deallocations = 0;
+        bytes = 0;
+        upstream_allocations = 0;
+    }
+};
+
+ostream& operator<<(ostream& os, const AllocationStats& stats) {
+    return os << "allocations=" << stats.allocations.load()
+              << " deallocations=" << stats.deallocations.load()
+              << " bytes=" << stats.bytes.load()
+              << " upstream=" << stats.upstream_allocations.load();
+}
+
+// サイズクラス (16, 32, ..., 512 バイト) ごとのフリーリストを持つプール。
+// 各スレッドはスレッドローカルなキャッシュから取り出し、足りなくなったら
+// 共有の置き場 (depot) かスラブ (64 KiB) の切り出しで補充する。
+// 別スレッドで解放されたブロックはそのスレッドのキャッシュに入る（スラブはプール全体のもの）
+class SizeClassPool {
+public:
+    static constexpr size_t min_block = 16;
+    static constexpr size_t max_block = 512;
+    static constexpr size_t class_count = 6;
+    static constexpr size_t max_align = 64;
+    static constexpr size_t slab_size = 64 * 1024;
+
+    static SizeClassPool& instance() {
+        static SizeClassPool pool;
+        return pool;
+    }
+
+    ~SizeClassPool() {
+        for (void* slab : slabs_) {
+            ::operator delete(slab, align_val_t(max_align));
+        }
+    }
+
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(max_align_t)) {
+        stats_.record_allocate(bytes);
+        size_t size = max(bytes, alignment);
+        if (size > max_block || alignment > max_align) {
+            stats_.upstream_allocations.fetch_add(1, memory_order_relaxed);
+            return ::operator new(bytes, align_val_t(alignment));
+        }
+
+        size_t c = class_index(size);
+        ThreadCache& cache = thread_cache();
+        if (!cache.heads[c]) refill(cache, c);
+        FreeBlock* block = cache.heads[c];
+        cache.heads[c] = block->next;
+        --cache.counts[c];
+        return block;
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(max_align_t)) noexcept {
+        stats_.record_deallocate();
+        size_t size = max(bytes, alignment);
+        if (size > max_block || alignment > max_align) {
+            ::operator delete(p, align_val_t(alignment));
+            return;
+        }
+
+        size_t c = class_index(size);
+        ThreadCache& cache = thread_cache();
+        auto* block = static_cast<FreeBlock*>(p);
+        block->next = cache.heads[c];
+        cache.heads[c] = block;
+        // 解放ばかりするスレッドのキャッシュが膨らみ続けないよう、溜まったら半分を depot に戻す
+        if (++cache.counts[c] * class_size(c) > 4 * slab_size) {
+            release_half(cache, c);
+        }
+    }
+
+    AllocationStats& stats() { return stats_; }
+
+    static constexpr size_t class_size(size_t c) { return min_block << c; }
+
+private:
+    SizeClassPool() = default;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct ThreadCache {
+        FreeBlock* heads[class_count] = {};
+        size_t counts[class_count] = {};
+
+        // スレッド終了時に手持ちのブロックを depot へ返す
+        ~ThreadCache() {
+            for (size_t c = 0; c < class_count; ++c) {
+                if (heads[c]) instance().give_back(c, heads[c]);
+            }
+        }
+    };
+
+    static ThreadCache& thread_cache() {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    static size_t class_index(size_t size) {
+        size_t c = 0;
+        while (class_size(c) < size) ++c;
+        return c;
+    }
+
+    // depot から最大 1 スラブ分をもらうか、新しいスラブを切り出す
+    void refill(ThreadCache& cache, size_t c) {
+        size_t block = class_size(c);
+        size_t batch = slab_size / block;
+        lock_guard<mutex> lock(mtx_);
+
+        if (FreeBlock* head = depot_[c]) {
+            FreeBlock* tail = head;
+            size_t n = 1;
+            while (n < batch && tail->next) {
+                tail = tail->next;
+                ++n;
+            }
+            depot_[c] = tail->next;
+            tail->next = nullptr;
+            cache.heads[c] = head;
+            cache.counts[c] = n;
+            return;
+        }
+
+        stats_.upstream_allocations.fetch_add(1, memory_order_relaxed);
+        char* slab = static_cast<char*>(::operator new(slab_size, align_val_t(max_align)));
+        slabs_.push_back(slab);
+        for (size_t i = 0; i < batch; ++i) {
+            auto* b = reinterpret_cast<FreeBlock*>(slab + i * block);
+            b->next = i + 1 < batch ? reinterpret_cast<FreeBlock*>(slab + (i + 1) * block) : nullptr;
+        }
+        cache.heads[c] = reinterpret_cast<FreeBlock*>(slab);
+        cache.counts[c] = batch;
+    }
+
+    void release_half(ThreadCache& cache, size_t c) {
+        size_t keep = cache.counts[c] / 2;
+        FreeBlock* last_kept = cache.heads[c];
+        for (size_t i = 1; i < keep; ++i) last_kept = last_kept->next;
+        FreeBlock* released = last_kept->next;
+        last_kept->next = nullptr;
+        cache.counts[c] = keep;
+        give_back(c, released);
+    }
+
+    void give_back(size_t c, FreeBlock* head) {
+        FreeBlock* tail = head;
+        while (tail->next) tail = tail->next;
+        lock_guard<mutex> lock(mtx_);
+        tail->next = depot_[c];
+        depot_[c] = head;
+    }
+
+    mutex mtx_;
+    FreeBlock* depot_[class_count] = {};
+    vector<void*> slabs_;
+    AllocationStats stats_;
+};
+
+// STL コンテナ用のアロケータ（list / map / set のノード向け）。状態を持たないので常に等価
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(SizeClassPool::instance().allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        SizeClassPool::instance().deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+};
+
+// SizeClassPool を pmr から使うためのアダプタ
+class PoolResource : public pmr::memory_resource {
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return SizeClassPool::instance().allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        SizeClassPool::instance().deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const PoolResource*>(&other) != nullptr;
+    }
+};
+
+// 単調増加アリーナ。確保はポインタを進めるだけで、deallocate は何もしない。
+// reset() は先頭チャンクに巻き戻すだけなので、確保したチャンクは次の周回で再利用される。
+// スレッドセーフではない（1 リクエスト・1 バッチごとに 1 つ持つ使い方を想定）
+class MonotonicArena : public pmr::memory_resource {
+public:
+    explicit MonotonicArena(size_t initial_chunk = 64 * 1024,
+                            pmr::memory_resource* upstream = pmr::new_delete_resource())
+        : upstream_(upstream) {
+        add_chunk(max<size_t>(initial_chunk, 64));
+    }
+
+    ~MonotonicArena() {
+        for (const auto& chunk : chunks_) {
+            upstream_->deallocate(chunk.data, chunk.size, max_align);
+        }
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    // アリーナ上にオブジェクトを作る。デストラクタは呼ばれないので、後始末の要らない型に使う
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+    }
+
+    // 確保済みの全オブジェクトを一括で捨てる
+    void reset() noexcept {
+        current_ = 0;
+        ptr_ = chunks_[0].data;
+        end_ = ptr_ + chunks_[0].size;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& chunk : chunks_) total += chunk.size;
+        return total;
+    }
+
+    AllocationStats& stats() { return stats_; }
+
+private:
+    static constexpr size_t max_align = alignof(max_align_t);
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        stats_.record_allocate(bytes);
+        while (true) {
+            auto addr = reinterpret_cast<uintptr_t>(ptr_);
+            auto aligned = (addr + alignment - 1) & ~(uintptr_t{alignment} - 1);
+            if (aligned + bytes <= reinterpret_cast<uintptr_t>(end_)) {
+                ptr_ = reinterpret_cast<char*>(aligned + bytes);
+                return reinterpret_cast<void*>(aligned);
+            }
+            next_chunk(bytes + alignment);
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        stats_.record_deallocate();
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    // reset() 前に使っていたチャンクが残っていれば再利用し、なければ倍の大きさで足す
+    void next_chunk(size_t min_size) {
+        while (++current_ < chunks_.size()) {
+            if (chunks_[current_].size >= min_size) {
+                ptr_ = chunks_[current_].data;
+                end_ = ptr_ + chunks_[current_].size;
+                return;
+            }
+        }
+        add_chunk(max(chunks_.back().size * 2, min_size));
+    }
+
+    void add_chunk(size_t size) {
+        stats_.upstream_allocations.fetch_add(1, memory_order_relaxed);
+        char* data = static_cast<char*>(upstream_->allocate(size, max_align));
+        chunks_.push_back({data, size});
+        current_ = chunks_.size() - 1;
+        ptr_ = data;
+        end_ = data + size;
+    }
+
+    pmr::memory_resource* upstream_;
+    vector<Chunk> chunks_;
+    size_t current_ = 0;
+    char* ptr_ = nullptr;
+    char* end_ = nullptr;
+    AllocationStats stats_;
+};
+
+// 上流のリソースに渡しつつ回数を数える。既存の pmr コードの確保回数を測るのに使う
+class CountingResource : public pmr::memory_resource {
+public:
+    explicit CountingResource(pmr::memory_resource* upstream = pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    AllocationStats& stats() { return stats_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        stats_.record_allocate(bytes);
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        stats_.record_deallocate();
+        upstream_->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    pmr::memory_resource* upstream_;
+    AllocationStats stats_;
+};
+
+void pool_allocator_demo() {
+    cout << "=== プールアロケータとアリーナ ===" << endl;
+    using namespace chrono;
+    constexpr int n = 200000;
+    auto& pool = SizeClassPool::instance();
+
+    // list のノードを malloc ではなくサイズクラスのフリーリストから取る
+    auto start = steady_clock::now();
+    {
+        list<int> nodes;
+        for (int i = 0; i < n; ++i) nodes.push_back(i);
+    }
+    auto std_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    pool.stats().reset();
+    start = steady_clock::now();
+    {
+        list<int, PoolAllocator<int>> nodes;
+        for (int i = 0; i < n; ++i) nodes.push_back(i);
+    }
+    auto pool_us = duration_cast<microseconds>(steady_clock::now() - start).count();
+    cout << "  list<int> x " << n << ": std::allocator " << std_us << " us, PoolAllocator "
+         << pool_us << " us" << endl;
+    cout << "  pool: " << pool.stats() << endl;
+
+    // 別スレッドで確保・解放しても、終了時にキャッシュが depot に戻って再利用される
+    thread worker([]() {
+        list<int, PoolAllocator<int>> nodes;
+        for (int i = 0; i < 1000; ++i) nodes.push_back(i);
+    });
+    worker.join();
+    size_t before = pool.stats().upstream_allocations;
+    {
+        list<int, PoolAllocator<int>> nodes;
+        for (int i = 0; i < 1000; ++i) nodes.push_back(i);
+    }
+    cout << "  New slabs after a worker thread exited: "
+         << pool.stats().upstream_allocations - before << endl;
+
+    // pmr コンテナ: 上流への確保回数を CountingResource で比較する
+    {
+        CountingResource direct;
+        pmr::list<pmr::string> names(&direct);
+        for (int i = 0; i < 1000; ++i) names.emplace_back("a-fairly-long-name-" + to_string(i));
+        cout << "  pmr::list<pmr::string> on new_delete: upstream allocations = "
+             << direct.stats().allocations << endl;
+    }
+    {
+        CountingResource upstream;
+        MonotonicArena arena(64 * 1024, &upstream);
+        for (int round = 0; round < 3; ++round) {
+            {
+                pmr::list<pmr::string> names(&arena);
+                for (int i = 0; i < 1000; ++i) names.emplace_back("a-fairly-long-name-" + to_string(i));
+            }
+            arena.reset();  // 1 周分をまとめて捨てる
+        }
+        cout << "  Same list x 3 rounds on MonotonicArena: arena allocations = "
+             << arena.stats().allocations << ", upstream allocations = "
+             << upstream.stats().allocations << " (capacity " << arena.capacity() << " bytes)" << endl;
+    }
+    {
+        PoolResource resource;
+        pmr::vector<pmr::list<int>> buckets(&resource);
+        buckets.resize(16);
+        for (int i = 0; i < 10000; ++i) buckets[i % 16].push_back(i);
+        cout << "  pmr containers on PoolResource: bucket[3].size() = " << buckets[3].size() << endl;
+    }
+
+    cout << endl;
+}
+
 // === placement new ===
 void placement_new_demo() {
     cout << "=== placement new ===" << endl;
@@ -364,7 +1135,136 @@ void placement_new_demo() {
     cout << endl;
 }
 
-int main() {
+// === ベンチマーク ===
+// `--bench [--filter 名前の一部] [--reps N] [--min-ms N] [--json]` で実行する。
+// allocate(bytes) / deallocate(p, bytes) を持つ確保元を同じ形で測る。
+// after_batch はアリーナの巻き戻し用（個別の解放がない確保元だけが使う）
+template<typename Allocate, typename Deallocate, typename AfterBatch>
+void bench_allocator(bench::Runner& runner, const string& name, Allocate allocate,
+                     Deallocate deallocate, AfterBatch after_batch) {
+    constexpr size_t bytes = 64;
+    constexpr size_t batch = 1000;
+
+    // 1 つ確保してすぐ返す（フリーリストの出し入れ）
+    runner.run("alloc_free/" + name + "/64", 1, "op", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            void* p = allocate(bytes);
+            bench::keep(p);
+            deallocate(p, bytes);
+            if (i % batch == batch - 1) after_batch();
+        }
+        after_batch();
+    });
+
+    // まとめて確保してから全部返す（木やリストの構築と破棄）
+    vector<void*> ptrs(batch);
+    runner.run("alloc_batch/" + name + "/64x1000", batch, "op", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            for (auto& p : ptrs) p = allocate(bytes);
+            bench::keep(ptrs);
+            for (void* p : ptrs) deallocate(p, bytes);
+            after_batch();
+        }
+    });
+}
+
+// make_list() で作った list<int> に 1000 要素入れて捨てる
+template<typename MakeList, typename AfterBatch>
+void bench_list(bench::Runner& runner, const string& name, MakeList make_list,
+                AfterBatch after_batch) {
+    runner.run("list/" + name + "/1000", 1000, "node", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            {
+                auto list = make_list();
+                for (int v = 0; v < 1000; ++v) list.push_back(v);
+                bench::keep(list);
+            }
+            after_batch();
+        }
+    });
+}
+
+void run_benchmarks(const bench::Options& options) {
+    bench::Runner runner("memory", options);
+    auto nothing = [] {};
+
+    bench_allocator(runner, "new_delete",
+                    [](size_t b) { return ::operator new(b); },
+                    [](void* p, size_t b) { ::operator delete(p, b); }, nothing);
+    bench_allocator(runner, "malloc", [](size_t b) { return malloc(b); },
+                    [](void* p, size_t) { free(p); }, nothing);
+    SizeClassPool& pool = SizeClassPool::instance();
+    bench_allocator(runner, "SizeClassPool", [&](size_t b) { return pool.allocate(b); },
+                    [&](void* p, size_t b) { pool.deallocate(p, b); }, nothing);
+    pmr::unsynchronized_pool_resource unsync;
+    bench_allocator(runner, "pmr_unsync_pool", [&](size_t b) { return unsync.allocate(b); },
+                    [&](void* p, size_t b) { unsync.deallocate(p, b); }, nothing);
+    pmr::synchronized_pool_resource sync;
+    bench_allocator(runner, "pmr_sync_pool", [&](size_t b) { return sync.allocate(b); },
+                    [&](void* p, size_t b) { sync.deallocate(p, b); }, nothing);
+    MonotonicArena arena;
+    bench_allocator(runner, "MonotonicArena", [&](size_t b) { return arena.allocate(b); },
+                    [&](void* p, size_t b) { arena.deallocate(p, b); }, [&] { arena.reset(); });
+
+    // ノードベースのコンテナに差し込んだとき
+    PoolResource pool_resource;
+    bench_list(runner, "std::allocator", [] { return list<int>(); }, nothing);
+    bench_list(runner, "PoolAllocator", [] { return list<int, PoolAllocator<int>>(); }, nothing);
+    bench_list(runner, "PoolResource", [&] { return pmr::list<int>(&pool_resource); }, nothing);
+    bench_list(runner, "pmr_unsync_pool", [&] { return pmr::list<int>(&unsync); }, nothing);
+    bench_list(runner, "MonotonicArena", [&] { return pmr::list<int>(&arena); },
+               [&] { arena.reset(); });
+
+    // 複数スレッドから同時に確保・解放する（items はスレッド数 × 回数）
+    size_t threads = max(2u, thread::hardware_concurrency());
+    auto concurrent = [&](const string& name, auto allocate, auto deallocate) {
+        runner.run("alloc_free_mt/" + name + "/64", static_cast<double>(threads), "op",
+                   [&](uint64_t n) {
+                       vector<thread> workers;
+                       for (size_t t = 0; t < threads; ++t) {
+                           workers.emplace_back([&] {
+                               for (uint64_t i = 0; i < n; ++i) {
+                                   void* p = allocate(64);
+                                   bench::keep(p);
+                                   deallocate(p, 64);
+                               }
+                           });
+                       }
+                       for (auto& w : workers) w.join();
+                   });
+    };
+    concurrent("new_delete", [](size_t b) { return ::operator new(b); },
+               [](void* p, size_t b) { ::operator delete(p, b); });
+    concurrent("SizeClassPool", [&](size_t b) { return pool.allocate(b); },
+               [&](void* p, size_t b) { pool.deallocate(p, b); });
+    concurrent("pmr_sync_pool", [&](size_t b) { return sync.allocate(b); },
+               [&](void* p, size_t b) { sync.deallocate(p, b); });
+
+    // 小さいうちはヒープを使わないバッファ
+    runner.run("small_buffer/SmallBuffer/16", 16, "elem", [](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            SmallBuffer<int> buffer;
+            for (int v = 0; v < 16; ++v) buffer.push_back(v);
+            bench::keep(buffer);
+        }
+    });
+    runner.run("small_buffer/std::vector/16", 16, "elem", [](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            vector<int> buffer;
+            for (int v = 0; v < 16; ++v) buffer.push_back(v);
+            bench::keep(buffer);
+        }
+    });
+
+    runner.finish();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string_view(argv[1]) == "--bench") {
+        run_benchmarks(bench::parse_options(vector<string>(argv + 2, argv + argc)));
+        return 0;
+    }
+
     cout << "=== Memory Management Demo ===" << endl << endl;
 
     stack_and_heap();
@@ -374,7 +1274,9 @@ int main() {
     raii_demo();
     move_semantics_demo();
     alignment_demo();
+    small_buffer_demo();
     custom_allocator_demo();
+    pool_allocator_demo();
     placement_new_demo();
 
     return 0;